@@ -0,0 +1,435 @@
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <strings.h>
+#include <vector>
+
+#include "../simulation.hpp"
+#include "../world.hpp"
+
+// Benchmarks the engine paths a frame or a new maze goes through, over a grid of map sizes and
+// braid percentages (Map::percentLessWalls) with fixed seeds, and prints one JSON object.
+//
+//   maze_bench [--quick] [--out results.json]
+//
+// Every case runs at least BENCH_MIN_REPS times and until BENCH_MIN_TIME has passed, the
+// reported time is the median rep. Allocations count operator new calls made while the timed
+// part runs, peak RSS is the high water mark of the process since the case started.
+
+constexpr int    BENCH_MIN_REPS = 3;
+constexpr int    BENCH_MAX_REPS = 50;
+constexpr double BENCH_MIN_TIME = 0.5;
+
+constexpr unsigned BENCH_SEED = 1;
+
+constexpr int CELL_SIZE  = 25;
+constexpr int WALL_WIDTH = 4;
+
+// the quad path only runs when zoomed in, so render prep is measured on a 1080p view at this
+// many pixels per cell
+constexpr int RENDER_WIDTH           = 1920;
+constexpr int RENDER_HEIGHT          = 1080;
+constexpr int RENDER_PIXELS_PER_CELL = 4;
+
+static const int FULL_SIZES[]   = {64, 256, 1024};
+static const int FULL_BRAIDS[]  = {0, 10, 50};
+static const int QUICK_SIZES[]  = {64, 256};
+static const int QUICK_BRAIDS[] = {0, 50};
+
+// the generators spread big mazes over several threads, their workers are joined before a
+// case reads the totals so relaxed is enough
+static std::atomic<size_t> allocationCount;
+static std::atomic<size_t> allocationBytes;
+
+void* operator new(size_t size) {
+
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+
+    void* memory = malloc(size ? size : 1);
+
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    free(memory);
+}
+
+// linux only, writing 5 to clear_refs resets VmHWM to the current rss
+static void reset_peak_rss() {
+
+    FILE* file = fopen("/proc/self/clear_refs", "w");
+
+    if (file) {
+        fputs("5", file);
+        fclose(file);
+    }
+}
+
+static long peak_rss_kb() {
+
+    FILE* file = fopen("/proc/self/status", "r");
+
+    if (!file) {
+        return -1;
+    }
+
+    char line[256];
+    long peak = -1;
+
+    while (fgets(line, sizeof(line), file)) {
+
+        if (strncmp(line, "VmHWM:", 6) == 0) {
+            peak = atol(line + 6);
+        }
+    }
+
+    fclose(file);
+
+    return peak;
+}
+
+static void silent_gl2d_error(const char*, void*) {
+}
+
+struct BenchCase {
+
+        const char* name;
+        int         width;
+        int         height;
+        int         braid;
+        size_t      cells; // cells a rep touches, what ns_per_cell divides by
+};
+
+// One case being measured. The caller sets up each rep untimed, then brackets the timed part
+// with begin and end.
+struct BenchTimer {
+
+        std::vector<double> times;
+        size_t              allocations;
+        size_t              allocatedBytes;
+        double              total;
+
+        std::chrono::steady_clock::time_point started;
+        size_t                                startCount;
+        size_t                                startBytes;
+
+        bool more();
+        void begin();
+        void end();
+};
+
+bool BenchTimer::more() {
+
+    int reps = (int)this->times.size();
+
+    return reps < BENCH_MIN_REPS || (reps < BENCH_MAX_REPS && this->total < BENCH_MIN_TIME);
+}
+
+void BenchTimer::begin() {
+
+    this->startCount = allocationCount.load(std::memory_order_relaxed);
+    this->startBytes = allocationBytes.load(std::memory_order_relaxed);
+    this->started    = std::chrono::steady_clock::now();
+}
+
+void BenchTimer::end() {
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->started).count();
+
+    this->allocations    += allocationCount.load(std::memory_order_relaxed) - this->startCount;
+    this->allocatedBytes += allocationBytes.load(std::memory_order_relaxed) - this->startBytes;
+    this->total          += seconds;
+
+    this->times.push_back(seconds);
+}
+
+struct BenchReport {
+
+        FILE* out;
+        int   written;
+
+        void begin();
+        void add(BenchCase& bench, BenchTimer& timer, long peakRss);
+        void end();
+};
+
+void BenchReport::begin() {
+
+    this->written = 0;
+
+    fprintf(this->out, "{\n  \"seed\": %u,\n  \"benchmarks\": [\n", BENCH_SEED);
+}
+
+void BenchReport::add(BenchCase& bench, BenchTimer& timer, long peakRss) {
+
+    std::vector<double>& times = timer.times;
+
+    std::sort(times.begin(), times.end());
+
+    int    reps   = (int)times.size();
+    double median = times[reps / 2];
+    double nsCell = median * 1e9 / std::max(bench.cells, (size_t)1);
+
+    fprintf(
+        this->out,
+        "%s    {\"name\": \"%s\", \"width\": %d, \"height\": %d, \"braid\": %d, \"cells\": %zu, \"reps\": %d, "
+        "\"ns_per_cell\": %.3f, \"cells_per_second\": %.0f, \"median_ms\": %.3f, \"min_ms\": %.3f, "
+        "\"allocations\": %zu, \"allocated_bytes\": %zu, \"peak_rss_kb\": %ld}",
+        this->written ? ",\n" : "",
+        bench.name,
+        bench.width,
+        bench.height,
+        bench.braid,
+        bench.cells,
+        reps,
+        nsCell,
+        nsCell > 0 ? 1e9 / nsCell : 0,
+        median * 1e3,
+        times[0] * 1e3,
+        timer.allocations / reps,
+        timer.allocatedBytes / reps,
+        peakRss
+    );
+
+    fflush(this->out);
+
+    this->written++;
+}
+
+void BenchReport::end() {
+    fprintf(this->out, "\n  ]\n}\n");
+}
+
+static void bench_generate(BenchReport& report, int size, int braid, Generator generator, const char* name) {
+
+    std::vector<Cell> cells((size_t)size * size);
+
+    Map map = {
+        .cells = cells.data(), .percentLessWalls = braid, .width = size, .height = size, .generator = generator
+    };
+
+    BenchCase  bench = {name, size, size, braid, map.length()};
+    BenchTimer timer = {};
+
+    reset_peak_rss();
+
+    for (unsigned seed = BENCH_SEED; timer.more(); seed++) {
+
+        timer.begin();
+
+        map.buildMaze(seed);
+
+        timer.end();
+    }
+
+    report.add(bench, timer, peak_rss_kb());
+}
+
+// mazes from generator, name says which
+static void bench_solve(
+    BenchReport& report, int size, int braid, SolveStrat strategy, Generator generator, const char* name
+) {
+
+    std::vector<Cell> cells((size_t)size * size);
+
+    Map map = {
+        .cells = cells.data(), .percentLessWalls = braid, .width = size, .height = size, .generator = generator
+    };
+
+    Player player = {.x = 0, .y = 0, .lastmoved = 0, .movecooldown = 0};
+
+    Simulation sim = {.map = &map, .player = &player, .strategy = strategy};
+
+    BenchCase  bench = {name, size, size, braid, map.length()};
+    BenchTimer timer = {};
+
+    reset_peak_rss();
+
+    for (unsigned seed = BENCH_SEED; timer.more(); seed++) {
+
+        map.buildMaze(seed);
+        map.clearDirty();
+
+        player.x = 0;
+        player.y = 0;
+
+        sim.restart();
+
+        // solving and walking the path back, as one run of the solver in the app
+        timer.begin();
+
+        while (!sim.pathShown) {
+            sim.step();
+        }
+
+        timer.end();
+    }
+
+    report.add(bench, timer, peak_rss_kb());
+}
+
+// World::renderMap on the quad path, which only builds gl2d's vertex arrays on the cpu until
+// a flush, so it runs without a window or a gl context
+static void bench_render(BenchReport& report, int size, int braid) {
+
+    // uninitialized gl2d reports every quad as using an invalid texture
+    gl2d::setErrorFuncCallback(silent_gl2d_error);
+
+    std::vector<Cell> cells((size_t)size * size);
+
+    World* world = new World{};
+
+    world->map = {.cells = cells.data(), .percentLessWalls = braid, .width = size, .height = size};
+
+    world->cellSize     = CELL_SIZE;
+    world->wallWidth    = WALL_WIDTH;
+    world->renderMode   = RENDER_QUADS;
+    world->screenWidth  = RENDER_WIDTH;
+    world->screenHeight = RENDER_HEIGHT;
+
+    gl2d::Camera camera = {};
+
+    camera.zoom = (float)RENDER_PIXELS_PER_CELL / CELL_SIZE;
+
+    // puts the top left corner of the map at the top left of the screen
+    glm::vec2 center = {RENDER_WIDTH / 2.0f, RENDER_HEIGHT / 2.0f};
+
+    camera.position = center / camera.zoom - center;
+
+    world->r2d.updateWindowMetrics(RENDER_WIDTH, RENDER_HEIGHT);
+    world->r2d.setCamera(camera);
+
+    int visibleWidth  = std::min(size, RENDER_WIDTH / RENDER_PIXELS_PER_CELL);
+    int visibleHeight = std::min(size, RENDER_HEIGHT / RENDER_PIXELS_PER_CELL);
+
+    BenchCase  bench = {"render/quads", size, size, braid, (size_t)visibleWidth * visibleHeight};
+    BenchTimer timer = {};
+
+    world->map.buildMaze(BENCH_SEED);
+
+    reset_peak_rss();
+
+    while (timer.more()) {
+
+        world->r2d.clearDrawData();
+
+        timer.begin();
+
+        world->renderMap();
+
+        timer.end();
+    }
+
+    report.add(bench, timer, peak_rss_kb());
+
+    delete world;
+}
+
+struct BenchOptions {
+
+        bool        quick;
+        const char* out;
+};
+
+static int run_benchmarks(BenchOptions* options) {
+
+    BenchReport report = {.out = stdout};
+
+    if (options->out) {
+
+        report.out = fopen(options->out, "w");
+
+        if (!report.out) {
+
+            fprintf(stderr, "could not write to %s\n", options->out);
+
+            return 1;
+        }
+    }
+
+    const int* sizes      = options->quick ? QUICK_SIZES : FULL_SIZES;
+    const int* braids     = options->quick ? QUICK_BRAIDS : FULL_BRAIDS;
+    int        sizeCount  = options->quick ? std::size(QUICK_SIZES) : std::size(FULL_SIZES);
+    int        braidCount = options->quick ? std::size(QUICK_BRAIDS) : std::size(FULL_BRAIDS);
+
+    report.begin();
+
+    for (int s = 0; s < sizeCount; s++) {
+
+        for (int b = 0; b < braidCount; b++) {
+
+            bench_generate(report, sizes[s], braids[b], GEN_BACKTRACKER, "generate/backtracker");
+            bench_generate(report, sizes[s], braids[b], GEN_DIVISION, "generate/division");
+            bench_generate(report, sizes[s], braids[b], GEN_BINARY_TREE, "generate/binarytree");
+            bench_generate(report, sizes[s], braids[b], GEN_SIDEWINDER, "generate/sidewinder");
+            bench_generate(report, sizes[s], braids[b], GEN_HUNT_AND_KILL, "generate/huntandkill");
+            bench_solve(report, sizes[s], braids[b], DFS, GEN_BACKTRACKER, "solve/dfs");
+            bench_solve(report, sizes[s], braids[b], FLOODFILL, GEN_BACKTRACKER, "solve/floodfill");
+
+            // sidewinder mazes build fast at any size and give the solvers long east-west corridors
+            bench_solve(report, sizes[s], braids[b], DFS, GEN_SIDEWINDER, "solve/dfs/sidewinder");
+            bench_solve(report, sizes[s], braids[b], FLOODFILL, GEN_SIDEWINDER, "solve/floodfill/sidewinder");
+            bench_render(report, sizes[s], braids[b]);
+        }
+    }
+
+    report.end();
+
+    if (report.out != stdout) {
+        fclose(report.out);
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+
+    BenchOptions options = {.quick = false, .out = nullptr};
+
+    for (int i = 1; i < argc; i++) {
+
+        if (strcasecmp(argv[i], "--quick") == 0) {
+
+            options.quick = true;
+
+        } else if (strcasecmp(argv[i], "--out") == 0 && i + 1 < argc) {
+
+            options.out = argv[++i];
+
+        } else {
+
+            fprintf(stderr, "usage: %s [--quick] [--out results.json]\n", argv[0]);
+
+            return 1;
+        }
+    }
+
+    return run_benchmarks(&options);
+}
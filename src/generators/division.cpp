@@ -0,0 +1,184 @@
+
+#include <vector>
+#include "../random.hpp"
+#include "../taskPool.hpp"
+#include "generators.hpp"
+
+// regions this big or smaller are divided all the way down by the task that got them
+constexpr size_t DIVISION_TASK_CELLS = GENERATOR_PARALLEL_CELLS;
+
+// a rectangle of cells walled all around and open inside
+struct DivisionRegion {
+
+        int x;
+        int y;
+        int width;
+        int height;
+};
+
+// a region handed to the pool, with the seed its task draws from
+struct DivisionTask {
+
+        DivisionRegion region;
+        unsigned       seed;
+};
+
+// every cell open except along the border, rows split over threads
+static void open_grid(Map& map, int threads) {
+
+    for_each_row_band(threads, map.height, [&map](int firstRow, int rowCount) {
+
+        for (int y = firstRow; y < firstRow + rowCount; y++) {
+
+            Cell* row = map.cells + (size_t)y * map.width;
+
+            for (int x = 0; x < map.width; x++) {
+
+                row[x] = {
+                    .state   = CELL_EMPTY,
+                    .walls   = {y == 0, y == map.height - 1, x == map.width - 1, x == 0},
+                    .visited = false,
+                };
+
+                if (map.carves) {
+                    publish_walls(&map, row + x);
+                }
+            }
+        }
+    });
+}
+
+// walls region off into two halves with one gap between them, false once it's a corridor
+static bool divide_region(Map& map, Random& random, DivisionRegion region, DivisionRegion halves[2]) {
+
+    if (region.width < 2 || region.height < 2) {
+        return false;
+    }
+
+    bool horizontal = region.height > region.width || (region.height == region.width && random.next() % 2);
+
+    // braiding leaves out parts of the wall besides the gap
+    auto keep = [&map, &random]() {
+        return map.percentLessWalls <= 0 || (random.next() % 100) >= map.percentLessWalls;
+    };
+
+    if (horizontal) {
+
+        int split = region.y + 1 + random.next() % (region.height - 1);
+        int gap   = region.x + random.next() % region.width;
+
+        Cell* above = map.cells + (size_t)(split - 1) * map.width;
+        Cell* below = above + map.width;
+
+        for (int x = region.x; x < region.x + region.width; x++) {
+
+            if (x != gap && keep()) {
+
+                above[x].walls[SOUTH] = true;
+                below[x].walls[NORTH] = true;
+
+                if (map.carves) {
+                    publish_walls(&map, above + x);
+                    publish_walls(&map, below + x);
+                }
+            }
+        }
+
+        halves[0] = {region.x, region.y, region.width, split - region.y};
+        halves[1] = {region.x, split, region.width, region.y + region.height - split};
+
+    } else {
+
+        int split = region.x + 1 + random.next() % (region.width - 1);
+        int gap   = region.y + random.next() % region.height;
+
+        for (int y = region.y; y < region.y + region.height; y++) {
+
+            if (y != gap && keep()) {
+
+                Cell* right = map.cells + (size_t)y * map.width + split;
+
+                right[-1].walls[EAST] = true;
+                right[0].walls[WEST]  = true;
+
+                if (map.carves) {
+                    publish_walls(&map, right - 1);
+                    publish_walls(&map, right);
+                }
+            }
+        }
+
+        halves[0] = {region.x, region.y, split - region.x, region.height};
+        halves[1] = {split, region.y, region.x + region.width - split, region.height};
+    }
+
+    return true;
+}
+
+// the rest of region on this thread, with its own stack instead of recursion
+static void divide_serial(Map& map, Random& random, DivisionRegion region) {
+
+    std::vector<DivisionRegion> stack = {region};
+
+    DivisionRegion halves[2];
+
+    while (!stack.empty()) {
+
+        region = stack.back();
+
+        stack.pop_back();
+
+        if (divide_region(map, random, region, halves)) {
+            stack.push_back(halves[1]);
+            stack.push_back(halves[0]);
+        }
+    }
+}
+
+// Recursive division: start from an open grid and keep splitting regions with a wall that has
+// one gap in it. The two halves of a split never touch the same cells again, so big regions
+// become tasks for a TaskPool. A task keeps dividing its region, handing off one half each
+// time, until what it holds is small enough to finish alone. Each task draws from a Random
+// seeded by the task that made it, so scheduling never changes the maze.
+glm::i32vec2 division_carve_maze(Map& map, unsigned seed) {
+
+    int threads = generator_threads(map);
+
+    open_grid(map, threads);
+
+    Random random;
+
+    random.seed(seed);
+
+    glm::i32vec2 finish(random.next() % map.width, random.next() % map.height);
+
+    TaskPool<DivisionTask> pool;
+
+    pool.start(threads);
+
+    DivisionTask root = {{0, 0, map.width, map.height}, (unsigned)random.next()};
+
+    pool.run(root, [&map, &pool](const DivisionTask& task, int worker) {
+
+        Random random;
+
+        random.seed(task.seed);
+
+        DivisionRegion region = task.region;
+        DivisionRegion halves[2];
+
+        while ((size_t)region.width * region.height > DIVISION_TASK_CELLS &&
+               divide_region(map, random, region, halves)) {
+
+            pool.push(worker, {halves[1], (unsigned)random.next()});
+
+            region = halves[0];
+        }
+
+        divide_serial(map, random, region);
+    });
+
+    pool.stop();
+
+    return finish;
+}
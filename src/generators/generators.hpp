@@ -0,0 +1,80 @@
+
+#ifndef GENERATORS_H
+#define GENERATORS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "glm/glm.hpp"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "../world.hpp"
+
+// mazes bigger than this are spread over every core
+constexpr size_t GENERATOR_PARALLEL_CELLS = 1 << 14;
+
+// a maze shown while it's carved stays on one thread, Map::carves takes a single producer
+inline int generator_threads(Map& map) {
+
+    if (map.carves) {
+        return 1;
+    }
+
+    return map.length() > GENERATOR_PARALLEL_CELLS ? std::max((int)std::thread::hardware_concurrency(), 1) : 1;
+}
+
+// index of the lowest set bit, word can't be 0
+inline int lowest_bit(uint64_t word) {
+#ifdef _MSC_VER
+    unsigned long index;
+
+    _BitScanForward64(&index, word);
+
+    return (int)index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+// runs work(firstRow, rowCount) for every band of rows, the first band on the calling thread
+template <typename F> void for_each_row_band(int threads, int rows, F work) {
+
+    int bandRows = (rows + threads - 1) / threads;
+
+    std::vector<std::thread> workers;
+
+    for (int t = 1; t * bandRows < rows; t++) {
+        workers.emplace_back(work, t * bandRows, std::min(bandRows, rows - t * bandRows));
+    }
+
+    work(0, std::min(bandRows, rows));
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// What Map::generate runs for each Generator.
+// Each one overwrites every cell of map and returns where the finish goes, the same seed always
+// gives the same maze however many threads it ran on. While map.carves is set every cell whose
+// walls change is also handed to publish_walls.
+
+// in world.cpp, call only while map->carves is set
+void publish_walls(Map* map, Cell* cell);
+
+glm::i32vec2 backtracker_carve_maze(Map& map, unsigned seed);
+
+glm::i32vec2 division_carve_maze(Map& map, unsigned seed);
+
+// in rows.cpp
+glm::i32vec2 binary_tree_carve_maze(Map& map, unsigned seed);
+glm::i32vec2 sidewinder_carve_maze(Map& map, unsigned seed);
+
+// single threaded, but needs no more than a bit per cell on top of the cells
+glm::i32vec2 hunt_and_kill_carve_maze(Map& map, unsigned seed);
+
+#endif
@@ -0,0 +1,298 @@
+
+#include <vector>
+#include "../random.hpp"
+#include "generators.hpp"
+
+// Which cells haven't been carved into yet, a bit per cell, plus a bit per row that still has any.
+// The only memory the generator needs besides the cells, about one bit per cell.
+struct UnvisitedCells {
+
+        std::vector<uint64_t> cells; // rowWords words per row, bits past the last column stay clear
+        std::vector<uint64_t> rows;
+        int                   rowWords;
+        int                   width;
+        int                   height;
+
+        void create(int width, int height) {
+
+            this->width    = width;
+            this->height   = height;
+            this->rowWords = (width + 63) / 64;
+
+            this->cells.assign((size_t)this->rowWords * height, ~(uint64_t)0);
+            this->rows.assign((height + 63) / 64, ~(uint64_t)0);
+
+            if (width % 64) {
+
+                for (int y = 0; y < height; y++) {
+                    this->word(y, this->rowWords - 1) = ((uint64_t)1 << width % 64) - 1;
+                }
+            }
+
+            if (height % 64) {
+                this->rows.back() = ((uint64_t)1 << height % 64) - 1;
+            }
+        }
+
+        uint64_t& word(int y, int i) {
+            return this->cells[(size_t)y * this->rowWords + i];
+        }
+
+        // out of bounds counts as visited, so nothing ever walks there
+        bool unvisited(int x, int y) {
+
+            if (x < 0 || y < 0 || x >= this->width || y >= this->height) {
+                return false;
+            }
+
+            return this->word(y, x >> 6) >> (x & 63) & 1;
+        }
+
+        void visit(int x, int y) {
+
+            uint64_t& word = this->word(y, x >> 6);
+
+            word &= ~((uint64_t)1 << (x & 63));
+
+            if (word) {
+                return;
+            }
+
+            for (int i = 0; i < this->rowWords; i++) {
+
+                if (this->word(y, i)) {
+                    return;
+                }
+            }
+
+            this->rows[y >> 6] &= ~((uint64_t)1 << (y & 63));
+        }
+
+        // visited cells of word i of row y, nothing for rows and words outside the maze
+        uint64_t visited(int y, int i) {
+
+            if (y < 0 || y >= this->height || i < 0 || i >= this->rowWords) {
+                return 0;
+            }
+
+            uint64_t inside = ~(uint64_t)0;
+
+            if (i == this->rowWords - 1 && this->width % 64) {
+                inside = ((uint64_t)1 << this->width % 64) - 1;
+            }
+
+            return ~this->word(y, i) & inside;
+        }
+
+        // first row at or after from that still has unvisited cells, -1 past the last one
+        int nextRow(int from) {
+
+            for (int i = from >> 6; i < (int)this->rows.size(); i++) {
+
+                uint64_t word = this->rows[i];
+
+                if (i == from >> 6) {
+                    word &= ~(uint64_t)0 << (from & 63);
+                }
+
+                if (word) {
+                    return i * 64 + lowest_bit(word);
+                }
+            }
+
+            return -1;
+        }
+
+        // an unvisited cell of row y next to a visited one, whole words at a time
+        bool hunt(int y, int& x) {
+
+            for (int i = 0; i < this->rowWords; i++) {
+
+                uint64_t unvisited = this->word(y, i);
+
+                if (!unvisited) {
+                    continue;
+                }
+
+                uint64_t here      = this->visited(y, i);
+                uint64_t neighbors = this->visited(y - 1, i) | this->visited(y + 1, i) |
+                                     here << 1 | this->visited(y, i - 1) >> 63 | here >> 1 |
+                                     this->visited(y, i + 1) << 63;
+
+                if (unvisited & neighbors) {
+
+                    x = i * 64 + lowest_bit(unvisited & neighbors);
+
+                    return true;
+                }
+            }
+
+            return false;
+        }
+};
+
+static glm::i32vec2 step(int x, int y, Direction d) {
+
+    switch (d) {
+    case NORTH: return {x, y - 1};
+    case SOUTH: return {x, y + 1};
+    case EAST : return {x + 1, y};
+    case WEST : return {x - 1, y};
+    }
+
+    return {x, y};
+}
+
+// one of the directions set in mask, mask can't be 0
+static Direction pick(Random& random, uint8_t mask) {
+
+    int count = 0;
+
+    for (int d = 0; d < 4; d++) {
+        count += mask >> d & 1;
+    }
+
+    int skip = random.next() % count;
+
+    for (int d = 0;; d++) {
+
+        if (!(mask >> d & 1)) {
+            continue;
+        }
+
+        if (skip-- == 0) {
+            return Direction(d);
+        }
+    }
+}
+
+static void carve(Map& map, int x, int y, Direction d) {
+
+    glm::i32vec2 to = step(x, y, d);
+
+    Cell* from = map.cells + (size_t)y * map.width + x;
+    Cell* into = map.cells + (size_t)to.y * map.width + to.x;
+
+    from->removeWall(d);
+    into->removeWall(opposite_direction(d));
+
+    if (map.carves) {
+        publish_walls(&map, from);
+        publish_walls(&map, into);
+    }
+}
+
+// Hunt and kill: walk at random into unvisited cells until stuck, then hunt for an unvisited cell
+// next to a visited one, join it to the maze and walk on from there. No stack and no recursion,
+// the walk only ever needs the cell it's on. The hunt picks up from the row the last one ended
+// on and wraps around, rows that are done are skipped a word of the row bitmap at a time.
+glm::i32vec2 hunt_and_kill_carve_maze(Map& map, unsigned seed) {
+
+    size_t length = map.length();
+
+    for (size_t i = 0; i < length; i++) {
+        map.cells[i] = {.state = CELL_EMPTY, .walls = {1, 1, 1, 1}, .visited = false};
+    }
+
+    UnvisitedCells unvisited;
+
+    unvisited.create(map.width, map.height);
+
+    Random random;
+
+    random.seed(seed);
+
+    int x = random.next() % map.width;
+    int y = random.next() % map.height;
+
+    glm::i32vec2 start(x, y);
+
+    unvisited.visit(x, y);
+
+    int huntRow = 0;
+
+    while (true) {
+
+        // kill, a random walk through unvisited cells
+        uint8_t open = 0;
+
+        for (int d = 0; d < 4; d++) {
+
+            glm::i32vec2 next = step(x, y, Direction(d));
+
+            open |= unvisited.unvisited(next.x, next.y) << d;
+        }
+
+        if (open) {
+
+            Direction d = pick(random, open);
+
+            carve(map, x, y, d);
+
+            glm::i32vec2 next = step(x, y, d);
+
+            x = next.x;
+            y = next.y;
+
+            unvisited.visit(x, y);
+
+            continue;
+        }
+
+        // braiding opens a dead end into another visited neighbor
+        if (map.percentLessWalls > 0 && (random.next() % 100) < map.percentLessWalls) {
+
+            Cell*   cell   = map.cells + (size_t)y * map.width + x;
+            uint8_t walled = 0;
+
+            walled |= (y > 0 && cell->walls[NORTH]) << NORTH;
+            walled |= (y < map.height - 1 && cell->walls[SOUTH]) << SOUTH;
+            walled |= (x < map.width - 1 && cell->walls[EAST]) << EAST;
+            walled |= (x > 0 && cell->walls[WEST]) << WEST;
+
+            if (walled) {
+                carve(map, x, y, pick(random, walled));
+            }
+        }
+
+        // hunt
+        int row = unvisited.nextRow(huntRow);
+
+        if (row < 0) {
+            row = unvisited.nextRow(0);
+        }
+
+        if (row < 0) {
+            break;
+        }
+
+        while (!unvisited.hunt(row, x)) {
+
+            row = unvisited.nextRow(row + 1);
+
+            if (row < 0) {
+                row = unvisited.nextRow(0);
+            }
+        }
+
+        y       = row;
+        huntRow = row;
+
+        uint8_t visited = 0;
+
+        for (int d = 0; d < 4; d++) {
+
+            glm::i32vec2 next = step(x, y, Direction(d));
+
+            bool inside = next.x >= 0 && next.y >= 0 && next.x < map.width && next.y < map.height;
+
+            visited |= (inside && !unvisited.unvisited(next.x, next.y)) << d;
+        }
+
+        carve(map, x, y, pick(random, visited));
+
+        unvisited.visit(x, y);
+    }
+
+    return start;
+}
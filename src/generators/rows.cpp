@@ -0,0 +1,186 @@
+
+#include <vector>
+#include "../random.hpp"
+#include "generators.hpp"
+
+// The passages one row opens, a bit per cell packed 64 to a word: east from x to x + 1,
+// north from x up into the row above. Neither generator here looks at any other row.
+struct RowCarves {
+
+        std::vector<uint64_t> east;
+        std::vector<uint64_t> north;
+};
+
+typedef void (*RowCarver)(Map& map, int y, RandomBits& bits, RowCarves& row);
+
+static bool bit_at(const std::vector<uint64_t>& words, int x) {
+    return words[x >> 6] >> (x & 63) & 1;
+}
+
+static void set_bit(std::vector<uint64_t>& words, int x) {
+    words[x >> 6] |= (uint64_t)1 << (x & 63);
+}
+
+static void clear_bit(std::vector<uint64_t>& words, int x) {
+    words[x >> 6] &= ~((uint64_t)1 << (x & 63));
+}
+
+// every cell goes north or east, a coin flip each, the top row and last column only have the one way
+static void binary_tree_row(Map& map, int y, RandomBits& bits, RowCarves& row) {
+
+    int last = map.width - 1;
+
+    for (size_t i = 0; i < row.east.size(); i++) {
+
+        uint64_t north = y > 0 ? bits.next() : 0;
+
+        row.north[i] = north;
+        row.east[i]  = ~north;
+    }
+
+    clear_bit(row.east, last);
+
+    if (y > 0) {
+        set_bit(row.north, last);
+    }
+}
+
+// runs of cells going east end on a coin flip and go north from one of their cells,
+// the top row is one run with nowhere to go
+static void sidewinder_row(Map& map, int y, RandomBits& bits, RowCarves& row) {
+
+    int last  = map.width - 1;
+    int words = (int)row.east.size();
+
+    for (int i = 0; i < words; i++) {
+        row.east[i]  = y > 0 ? bits.next() : ~(uint64_t)0;
+        row.north[i] = 0;
+    }
+
+    clear_bit(row.east, last);
+
+    if (y == 0) {
+        return;
+    }
+
+    int start = 0;
+
+    for (int i = 0; i < words; i++) {
+
+        uint64_t ends = ~row.east[i];
+
+        // bits past the last column
+        if (i == words - 1 && map.width % 64) {
+            ends &= ((uint64_t)1 << map.width % 64) - 1;
+        }
+
+        for (; ends; ends &= ends - 1) {
+
+            int x = i * 64 + lowest_bit(ends);
+
+            set_bit(row.north, start + bits.next() % (x - start + 1));
+
+            start = x + 1;
+        }
+    }
+}
+
+// braiding opens the way a cell didn't take as well
+static void braid_row(Map& map, int y, RandomBits& bits, RowCarves& row) {
+
+    if (map.percentLessWalls <= 0 || y == 0) {
+        return;
+    }
+
+    for (int x = 0; x < map.width; x++) {
+
+        if (bits.next() % 100 >= (uint64_t)map.percentLessWalls) {
+            continue;
+        }
+
+        set_bit(row.north, x);
+
+        if (x < map.width - 1) {
+            set_bit(row.east, x);
+        }
+    }
+}
+
+// Writes row y from its carves. The south walls of the row above are this row's north passages,
+// so a row writes those and leaves its own to the row below, no wall has two writers.
+static void write_row(Map& map, int y, RowCarves& row) {
+
+    Cell* cells = map.cells + (size_t)y * map.width;
+    Cell* above = cells - map.width;
+
+    for (int x = 0; x < map.width; x++) {
+
+        bool north = bit_at(row.north, x);
+
+        cells[x].state        = CELL_EMPTY;
+        cells[x].walls[NORTH] = !north;
+        cells[x].walls[EAST]  = !bit_at(row.east, x);
+        cells[x].walls[WEST]  = x == 0 || !bit_at(row.east, x - 1);
+        cells[x].visited      = false;
+        cells[x].distance     = 0;
+
+        if (y > 0) {
+            above[x].walls[SOUTH] = !north;
+        }
+    }
+
+    if (y == map.height - 1) {
+
+        for (int x = 0; x < map.width; x++) {
+            cells[x].walls[SOUTH] = true;
+        }
+    }
+
+    // the row above is finished now that its south walls are in
+    for (int x = 0; map.carves && x < map.width; x++) {
+
+        if (y > 0) {
+            publish_walls(&map, above + x);
+        }
+
+        publish_walls(&map, cells + x);
+    }
+}
+
+// Every row draws from its own RandomBits seeded with the maze seed and the row, so rows are
+// carved in bands on as many threads as there are cores and the maze still only depends on seed.
+static glm::i32vec2 carve_rows(Map& map, unsigned seed, RowCarver carve) {
+
+    int words = (map.width + 63) / 64;
+
+    for_each_row_band(generator_threads(map), map.height, [&map, seed, carve, words](int firstRow, int rowCount) {
+
+        RowCarves  row = {std::vector<uint64_t>(words), std::vector<uint64_t>(words)};
+        RandomBits bits;
+
+        for (int y = firstRow; y < firstRow + rowCount; y++) {
+
+            bits.seed((uint64_t)seed << 32 | (uint32_t)y);
+
+            carve(map, y, bits, row);
+
+            braid_row(map, y, bits, row);
+
+            write_row(map, y, row);
+        }
+    });
+
+    Random random;
+
+    random.seed(seed);
+
+    return glm::i32vec2(random.next() % map.width, random.next() % map.height);
+}
+
+glm::i32vec2 binary_tree_carve_maze(Map& map, unsigned seed) {
+    return carve_rows(map, seed, binary_tree_row);
+}
+
+glm::i32vec2 sidewinder_carve_maze(Map& map, unsigned seed) {
+    return carve_rows(map, seed, sidewinder_row);
+}
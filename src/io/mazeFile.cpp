@@ -0,0 +1,219 @@
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "mazeFile.hpp"
+
+// distances go out this many at a time
+constexpr size_t DISTANCE_CHUNK = 1 << 16;
+
+static size_t walls_size(size_t cells) {
+    return (cells + 3) / 4;
+}
+
+bool save_maze(const char* path, Map& map, bool withDistances) {
+
+    size_t cells = map.length();
+
+    MazeFileHeader header = {};
+
+    memcpy(header.magic, "MAZE", 4);
+
+    header.version   = MAZE_FILE_VERSION;
+    header.flags     = withDistances ? MAZE_FILE_DISTANCES : 0;
+    header.width     = map.width;
+    header.height    = map.height;
+    header.finishX   = map.finishPos.x;
+    header.finishY   = map.finishPos.y;
+    header.generator = map.generator;
+    header.seed      = map.seed;
+
+    header.wallsOffset = sizeof(MazeFileHeader);
+
+    // keep the distance plane aligned so it can be read in place
+    header.distancesOffset = withDistances ? (header.wallsOffset + walls_size(cells) + 7) / 8 * 8 : 0;
+
+    std::vector<uint8_t> walls(walls_size(cells), 0);
+
+    for (size_t i = 0; i < cells; i++) {
+
+        Cell& cell = map.cells[i];
+
+        uint8_t bits = cell.walls[SOUTH] | cell.walls[EAST] << 1;
+
+        walls[i / 4] |= bits << (i % 4 * 2);
+    }
+
+    FILE* file = fopen(path, "wb");
+
+    if (!file) {
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    ok = ok && fwrite(walls.data(), 1, walls.size(), file) == walls.size();
+
+    if (withDistances && ok) {
+
+        size_t  padding  = header.distancesOffset - header.wallsOffset - walls.size();
+        uint8_t zeros[8] = {};
+
+        ok = fwrite(zeros, 1, padding, file) == padding;
+
+        std::vector<int32_t> chunk(DISTANCE_CHUNK);
+
+        for (size_t i = 0; i < cells && ok; i += DISTANCE_CHUNK) {
+
+            size_t count = std::min(DISTANCE_CHUNK, cells - i);
+
+            for (size_t k = 0; k < count; k++) {
+                chunk[k] = map.cells[i + k].distance;
+            }
+
+            ok = fwrite(chunk.data(), sizeof(int32_t), count, file) == count;
+        }
+    }
+
+    return fclose(file) == 0 && ok;
+}
+
+bool MazeView::open(const char* path) {
+
+    int fd = ::open(path, O_RDONLY);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(MazeFileHeader)) {
+
+        ::close(fd);
+
+        return false;
+    }
+
+    this->size = info.st_size;
+    this->base = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping stays valid without the descriptor
+    ::close(fd);
+
+    if (this->base == MAP_FAILED) {
+
+        this->base = nullptr;
+
+        return false;
+    }
+
+    const uint8_t* bytes = (const uint8_t*)this->base;
+
+    this->header = (const MazeFileHeader*)bytes;
+
+    const MazeFileHeader* header = this->header;
+
+    // Map keeps its size in ints
+    bool valid = memcmp(header->magic, "MAZE", 4) == 0 && header->version == MAZE_FILE_VERSION &&
+                 header->width > 0 && header->height > 0 && header->width <= INT_MAX && header->height <= INT_MAX;
+
+    // both below 2^31, so this can't wrap
+    size_t cells = (size_t)header->width * header->height;
+
+    // offsets come from the file, compare against what's left after them instead of adding to them
+    valid = valid && header->finishX >= 0 && (uint32_t)header->finishX < header->width && header->finishY >= 0 &&
+            (uint32_t)header->finishY < header->height && header->wallsOffset <= this->size &&
+            walls_size(cells) <= this->size - header->wallsOffset;
+
+    if (valid && header->flags & MAZE_FILE_DISTANCES) {
+        valid = header->distancesOffset % 4 == 0 && header->distancesOffset <= this->size &&
+                cells <= (this->size - header->distancesOffset) / sizeof(int32_t);
+    }
+
+    if (!valid) {
+
+        this->close();
+
+        return false;
+    }
+
+    this->walls     = bytes + this->header->wallsOffset;
+    this->distances = nullptr;
+
+    if (this->header->flags & MAZE_FILE_DISTANCES) {
+        this->distances = (const int32_t*)(bytes + this->header->distancesOffset);
+    }
+
+    return true;
+}
+
+void MazeView::close() {
+
+    if (this->base) {
+        munmap(this->base, this->size);
+    }
+
+    this->base   = nullptr;
+    this->header = nullptr;
+}
+
+// the two bits a cell keeps for itself, bit 0 south and bit 1 east
+static int cell_bits(const uint8_t* walls, size_t i) {
+    return walls[i / 4] >> (i % 4 * 2) & 3;
+}
+
+bool MazeView::wallAt(int x, int y, Direction d) {
+
+    size_t width = this->header->width;
+
+    switch (d) {
+    case NORTH:
+        return y == 0 || cell_bits(this->walls, (y - 1) * width + x) & 1;
+    case SOUTH:
+        return cell_bits(this->walls, y * width + x) & 1;
+    case EAST:
+        return cell_bits(this->walls, y * width + x) & 2;
+    case WEST:
+        return x == 0 || cell_bits(this->walls, y * width + x - 1) & 2;
+    }
+
+    return true;
+}
+
+int MazeView::distance(int x, int y) {
+    return this->distances ? this->distances[(size_t)y * this->header->width + x] : 0;
+}
+
+void MazeView::toMap(Map& map) {
+
+    map.width     = this->header->width;
+    map.height    = this->header->height;
+    map.finishPos = {this->header->finishX, this->header->finishY};
+    map.generator = (Generator)this->header->generator;
+    map.seed      = this->header->seed;
+
+    for (int y = 0; y < map.height; y++) {
+
+        for (int x = 0; x < map.width; x++) {
+
+            Cell* cell = map.at(x, y);
+
+            *cell = {.state = CELL_EMPTY, .visited = false, .distance = this->distance(x, y)};
+
+            for (int d = 0; d < 4; d++) {
+                cell->walls[d] = this->wallAt(x, y, Direction(d));
+            }
+        }
+    }
+
+    map.at(map.finishPos.x, map.finishPos.y)->state = CELL_FINISH;
+
+    map.mazeChanged();
+}
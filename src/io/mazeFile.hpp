@@ -0,0 +1,59 @@
+
+#ifndef MAZE_FILE_H
+#define MAZE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "../world.hpp"
+
+constexpr uint16_t MAZE_FILE_VERSION = 1;
+
+// flags
+constexpr uint16_t MAZE_FILE_DISTANCES = 1;
+
+// Layout of a saved maze, in native byte order (little endian everywhere we run):
+//   the header below
+//   walls, 2 bits per cell in row major order, 4 cells to a byte starting at the low bits;
+//   bit 0 is the south wall and bit 1 the east wall, north and west come from the neighbour
+//   (or the border, which always has walls)
+//   distances, an int32 per cell in row major order, only with MAZE_FILE_DISTANCES
+struct MazeFileHeader {
+
+        char     magic[4]; // "MAZE"
+        uint16_t version;
+        uint16_t flags;
+        uint32_t width;
+        uint32_t height;
+        int32_t  finishX;
+        int32_t  finishY;
+        uint32_t generator;
+        uint32_t seed;
+        uint64_t wallsOffset;
+        uint64_t distancesOffset;
+};
+
+bool save_maze(const char* path, Map& map, bool withDistances);
+
+// A saved maze mapped straight from disk, nothing is copied until toMap.
+// wallAt and distance read the file in place, but the app always goes through toMap: solving
+// writes state, visited and distance into every cell and the renderers read Cells, so a loaded
+// maze gets its own writable copy and the view is closed right after.
+struct MazeView {
+
+        void*                 base;
+        size_t                size;
+        const MazeFileHeader* header;
+        const uint8_t*        walls;
+        const int32_t*        distances; // null without MAZE_FILE_DISTANCES
+
+        bool open(const char* path);
+        void close();
+
+        bool wallAt(int x, int y, Direction d);
+        int  distance(int x, int y);
+
+        // fills map with the maze, map.cells needs room for width * height cells
+        void toMap(Map& map);
+};
+
+#endif
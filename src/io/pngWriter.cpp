@@ -0,0 +1,342 @@
+
+#include <cstring>
+#include "pngWriter.hpp"
+
+constexpr uint32_t ADLER_BASE = 65521;
+
+// deflate can't match more than this many bytes at once
+constexpr size_t MAX_MATCH = 258;
+
+static const uint16_t LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                         31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+
+static const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                         2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+// distances we look for matches at, the pixel before and the byte before (runs of zeros from
+// the up filter), anything further away isn't worth the search for a maze
+static const size_t MATCH_DISTANCES[2] = {3, 1};
+
+struct BitWriter {
+
+        std::vector<uint8_t>& out;
+        uint64_t              bits;
+        int                   count;
+
+        void put(uint32_t value, int n) {
+
+            this->bits |= (uint64_t)value << this->count;
+            this->count += n;
+
+            while (this->count >= 8) {
+
+                this->out.push_back((uint8_t)this->bits);
+
+                this->bits >>= 8;
+                this->count -= 8;
+            }
+        }
+
+        void align() {
+
+            if (this->count > 0) {
+                this->put(0, 8 - this->count);
+            }
+        }
+};
+
+static uint32_t reverse_bits(uint32_t code, int n) {
+
+    uint32_t reversed = 0;
+
+    for (int i = 0; i < n; i++) {
+        reversed |= ((code >> i) & 1) << (n - 1 - i);
+    }
+
+    return reversed;
+}
+
+// huffman codes go into the stream most significant bit first, everything else the other way around
+static void put_symbol(BitWriter& w, int symbol) {
+
+    if (symbol < 144) {
+        w.put(reverse_bits(0x30 + symbol, 8), 8);
+    } else if (symbol < 256) {
+        w.put(reverse_bits(0x190 + symbol - 144, 9), 9);
+    } else if (symbol < 280) {
+        w.put(reverse_bits(symbol - 256, 7), 7);
+    } else {
+        w.put(reverse_bits(0xc0 + symbol - 280, 8), 8);
+    }
+}
+
+static void put_match(BitWriter& w, size_t length, size_t distance) {
+
+    int code = 28;
+
+    while (LENGTH_BASE[code] > length) {
+        code--;
+    }
+
+    put_symbol(w, 257 + code);
+
+    w.put(length - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+
+    // distances up to 4 have a code of their own and no extra bits
+    w.put(reverse_bits(distance - 1, 5), 5);
+}
+
+struct CrcTable {
+
+        uint32_t entries[256];
+
+        CrcTable() {
+
+            for (uint32_t i = 0; i < 256; i++) {
+
+                uint32_t c = i;
+
+                for (int k = 0; k < 8; k++) {
+                    c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+                }
+
+                this->entries[i] = c;
+            }
+        }
+};
+
+static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length) {
+
+    // built once, bands are encoded from several threads
+    static const CrcTable table;
+
+    crc = ~crc;
+
+    for (size_t i = 0; i < length; i++) {
+        crc = table.entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+static uint32_t adler32(const uint8_t* data, size_t length) {
+
+    uint32_t a = 1;
+    uint32_t b = 0;
+
+    while (length > 0) {
+
+        // the largest run the sums can't overflow in
+        size_t run = length < 5552 ? length : 5552;
+
+        for (size_t i = 0; i < run; i++) {
+            a += data[i];
+            b += a;
+        }
+
+        a %= ADLER_BASE;
+        b %= ADLER_BASE;
+
+        data += run;
+        length -= run;
+    }
+
+    return b << 16 | a;
+}
+
+// the adler32 of two buffers back to back from the adler32 of each
+static uint32_t adler32_combine(uint32_t first, uint32_t second, size_t secondLength) {
+
+    uint32_t rem  = secondLength % ADLER_BASE;
+    uint32_t sum1 = first & 0xffff;
+    uint32_t sum2 = (uint32_t)(((uint64_t)rem * sum1) % ADLER_BASE);
+
+    sum1 += (second & 0xffff) + ADLER_BASE - 1;
+    sum2 += (first >> 16) + (second >> 16) + ADLER_BASE - rem;
+
+    if (sum1 >= ADLER_BASE)
+        sum1 -= ADLER_BASE;
+    if (sum1 >= ADLER_BASE)
+        sum1 -= ADLER_BASE;
+    if (sum2 >= ADLER_BASE << 1)
+        sum2 -= ADLER_BASE << 1;
+    if (sum2 >= ADLER_BASE)
+        sum2 -= ADLER_BASE;
+
+    return sum2 << 16 | sum1;
+}
+
+static void put_u32(uint8_t* out, uint32_t value) {
+
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+}
+
+static bool write_chunk(FILE* file, const char* type, const uint8_t* data, size_t length) {
+
+    uint8_t header[8];
+
+    put_u32(header, (uint32_t)length);
+    memcpy(header + 4, type, 4);
+
+    uint8_t crc[4];
+
+    put_u32(crc, crc32(crc32(0, header + 4, 4), data, length));
+
+    return fwrite(header, 1, 8, file) == 8 && fwrite(data, 1, length, file) == length && fwrite(crc, 1, 4, file) == 4;
+}
+
+// rows are tightly packed rgb, prevRow is the image row above the first one or null at the top
+void PngBand::encode(const uint8_t* rows, const uint8_t* prevRow, int width, int rowCount) {
+
+    size_t stride = (size_t)width * 3;
+
+    // a row identical to the one above turns into zeros under the up filter, everything
+    // else is left unfiltered so repeated pixels stay repeated
+    this->filtered.resize((stride + 1) * rowCount);
+
+    for (int y = 0; y < rowCount; y++) {
+
+        const uint8_t* row  = rows + stride * y;
+        const uint8_t* prev = y > 0 ? row - stride : prevRow;
+        uint8_t*       out  = &this->filtered[(stride + 1) * y];
+
+        if (prev && memcmp(row, prev, stride) == 0) {
+
+            out[0] = 2;
+
+            memset(out + 1, 0, stride);
+
+        } else {
+
+            out[0] = 0;
+
+            memcpy(out + 1, row, stride);
+        }
+    }
+
+    this->length = this->filtered.size();
+    this->adler  = adler32(this->filtered.data(), this->length);
+
+    // room for the chunk length and type, filled in at the end
+    this->chunk.assign(8, 0);
+
+    BitWriter w = {this->chunk, 0, 0};
+
+    // one fixed huffman block, not final
+    w.put(0, 1);
+    w.put(1, 2);
+
+    const uint8_t* data = this->filtered.data();
+
+    for (size_t i = 0; i < this->length;) {
+
+        size_t best     = 0;
+        size_t distance = 0;
+
+        for (size_t d : MATCH_DISTANCES) {
+
+            if (i < d) {
+                continue;
+            }
+
+            size_t n = 0;
+
+            while (n < MAX_MATCH && i + n < this->length && data[i + n] == data[i + n - d]) {
+                n++;
+            }
+
+            if (n > best) {
+                best     = n;
+                distance = d;
+            }
+        }
+
+        if (best >= 3) {
+
+            put_match(w, best, distance);
+
+            i += best;
+
+        } else {
+
+            put_symbol(w, data[i]);
+
+            i++;
+        }
+    }
+
+    // end of block, then an empty stored block to land on a byte boundary so the next
+    // band can start a block of its own
+    put_symbol(w, 256);
+
+    w.put(0, 3);
+    w.align();
+
+    const uint8_t sync[4] = {0x00, 0x00, 0xff, 0xff};
+
+    this->chunk.insert(this->chunk.end(), sync, sync + 4);
+
+    size_t dataLength = this->chunk.size() - 8;
+
+    put_u32(&this->chunk[0], (uint32_t)dataLength);
+    memcpy(&this->chunk[4], "IDAT", 4);
+
+    uint8_t crc[4];
+
+    put_u32(crc, crc32(0, &this->chunk[4], dataLength + 4));
+
+    this->chunk.insert(this->chunk.end(), crc, crc + 4);
+}
+
+bool PngWriter::begin(const char* path, int width, int height) {
+
+    this->file = fopen(path, "wb");
+
+    if (!this->file) {
+        return false;
+    }
+
+    this->adler = 1;
+
+    const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+    // 8 bits per channel, rgb, deflate, default filtering, not interlaced
+    uint8_t header[13] = {0, 0, 0, 0, 0, 0, 0, 0, 8, 2, 0, 0, 0};
+
+    put_u32(header, (uint32_t)width);
+    put_u32(header + 4, (uint32_t)height);
+
+    // zlib header, deflate with a 32k window and no preset dictionary
+    const uint8_t zlib[2] = {0x78, 0x01};
+
+    if (fwrite(signature, 1, 8, this->file) == 8 && write_chunk(this->file, "IHDR", header, 13) &&
+        write_chunk(this->file, "IDAT", zlib, 2)) {
+        return true;
+    }
+
+    fclose(this->file);
+
+    return false;
+}
+
+bool PngWriter::writeBand(PngBand& band) {
+
+    this->adler = adler32_combine(this->adler, band.adler, band.length);
+
+    return fwrite(band.chunk.data(), 1, band.chunk.size(), this->file) == band.chunk.size();
+}
+
+bool PngWriter::end() {
+
+    // an empty final fixed huffman block, then the checksum of everything the bands held
+    uint8_t trailer[6] = {0x03, 0x00};
+
+    put_u32(trailer + 2, this->adler);
+
+    bool ok = write_chunk(this->file, "IDAT", trailer, 6) && write_chunk(this->file, "IEND", nullptr, 0);
+
+    return fclose(this->file) == 0 && ok;
+}
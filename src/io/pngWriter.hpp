@@ -0,0 +1,35 @@
+
+#ifndef PNG_WRITER_H
+#define PNG_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// One run of whole rows compressed on its own, ready to go out as a single IDAT chunk.
+// Bands don't reference each other's bytes, so any number of them can be encoded at once.
+struct PngBand {
+
+        std::vector<uint8_t> chunk;  // length, type, deflate data and crc
+        std::vector<uint8_t> filtered;
+        uint32_t             adler;  // of the filtered rows
+        size_t               length; // of the filtered rows
+
+        void encode(const uint8_t* rows, const uint8_t* prevRow, int width, int rowCount);
+};
+
+// Streams an 8 bit rgb png out band by band, the image is never held in memory as a whole.
+// Compression is fixed huffman deflate that only looks for repeated pixels and repeated rows,
+// which covers almost everything a maze is made of at a fraction of the cost of a real encoder.
+struct PngWriter {
+
+        FILE*    file;
+        uint32_t adler;
+
+        bool begin(const char* path, int width, int height);
+        bool writeBand(PngBand& band);
+        bool end();
+};
+
+#endif
@@ -0,0 +1,499 @@
+
+#include <algorithm>
+#include <cstring>
+#include <strings.h>
+#include <thread>
+#include <unistd.h>
+#include "../world.hpp"
+#include "recording.hpp"
+#include "snapshot.hpp"
+
+static const char RECORDING_MAGIC[8] = {'M', 'A', 'Z', 'E', 'R', 'E', 'C', '1'};
+
+constexpr int RECORD_CELL    = 0;
+constexpr int RECORD_PALETTE = 1;
+constexpr int RECORD_MAZE    = 2;
+
+// buffered records go out once they pass this
+constexpr size_t RECORDING_FLUSH_SIZE = 1 << 20;
+
+// frames bigger than this on either side get a smaller cell size
+constexpr int ENCODE_MAX_SIDE = 2048;
+
+// frames per maze when the frame size in events isn't given
+constexpr int ENCODE_DEFAULT_FRAMES = 300;
+
+struct RecordedEvent {
+
+        int     index;
+        uint8_t color;
+};
+
+struct RecordedMaze {
+
+        int                        width;
+        int                        height;
+        std::vector<uint8_t>       walls;
+        std::vector<uint8_t>       colors;
+        std::vector<RecordedEvent> events;
+};
+
+// a frame shows a maze with its first events applied
+struct RecordedFrame {
+
+        int    maze;
+        size_t events;
+};
+
+static int64_t unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static uint64_t zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+bool Recorder::begin(const char* path) {
+
+    this->file = fopen(path, "wb");
+
+    if (!this->file) {
+        return false;
+    }
+
+    this->sentStates = 0;
+    this->lastIndex  = 0;
+
+    this->buffer.assign(RECORDING_MAGIC, RECORDING_MAGIC + 8);
+
+    return true;
+}
+
+void Recorder::putVarint(uint64_t value) {
+
+    while (value >= 0x80) {
+
+        this->buffer.push_back((uint8_t)(value | 0x80));
+
+        value >>= 7;
+    }
+
+    this->buffer.push_back((uint8_t)value);
+}
+
+void Recorder::flush(size_t threshold) {
+
+    if (this->buffer.size() < threshold) {
+        return;
+    }
+
+    fwrite(this->buffer.data(), 1, this->buffer.size(), this->file);
+
+    this->buffer.clear();
+}
+
+static_assert(CELL_STATE_COUNT <= 32, "Recorder::sentStates has a bit per cell state");
+
+// the state is the index, its color goes out the first time it's used
+uint8_t Recorder::paletteIndex(uint8_t state) {
+
+    if (this->sentStates >> state & 1) {
+        return state;
+    }
+
+    this->sentStates |= 1u << state;
+
+    gl2d::Color4f color = cellPalette[state];
+
+    this->putVarint(RECORD_PALETTE);
+
+    this->buffer.push_back(state);
+    this->buffer.push_back((uint8_t)(std::clamp(color.r, 0.0f, 1.0f) * 255.0f + 0.5f));
+    this->buffer.push_back((uint8_t)(std::clamp(color.g, 0.0f, 1.0f) * 255.0f + 0.5f));
+    this->buffer.push_back((uint8_t)(std::clamp(color.b, 0.0f, 1.0f) * 255.0f + 0.5f));
+
+    return state;
+}
+
+void Recorder::beginMaze(Map& map) {
+
+    // palette records have to come before the maze record that uses them
+    std::vector<uint8_t> colors(map.length());
+
+    for (size_t i = 0; i < colors.size(); i++) {
+        colors[i] = this->paletteIndex(map.cells[i].state);
+    }
+
+    this->putVarint(RECORD_MAZE);
+    this->putVarint(map.width);
+    this->putVarint(map.height);
+
+    for (size_t i = 0; i < colors.size(); i++) {
+
+        bool* walls = map.cells[i].walls;
+
+        this->buffer.push_back(walls[NORTH] << NORTH | walls[SOUTH] << SOUTH | walls[EAST] << EAST | walls[WEST] << WEST);
+        this->buffer.push_back(colors[i]);
+
+        this->flush(RECORDING_FLUSH_SIZE);
+    }
+
+    this->lastIndex = 0;
+}
+
+void Recorder::cellChanged(int index, uint8_t state) {
+
+    uint8_t paletteIndex = this->paletteIndex(state);
+
+    // solvers mostly move to a neighbour, so the distance from the last change stays small
+    this->putVarint(zigzag((int64_t)index - this->lastIndex) << 2 | RECORD_CELL);
+
+    this->buffer.push_back(paletteIndex);
+
+    this->lastIndex = index;
+
+    this->flush(RECORDING_FLUSH_SIZE);
+}
+
+bool Recorder::end() {
+
+    this->flush(0);
+
+    bool ok = !ferror(this->file);
+
+    return fclose(this->file) == 0 && ok;
+}
+
+struct RecordingReader {
+
+        const uint8_t* data;
+        size_t         length;
+        size_t         at;
+        bool           failed;
+
+        uint64_t varint() {
+
+            uint64_t value = 0;
+
+            for (int shift = 0; shift < 64; shift += 7) {
+
+                if (this->at >= this->length) {
+                    break;
+                }
+
+                uint8_t byte = this->data[this->at++];
+
+                value |= (uint64_t)(byte & 0x7f) << shift;
+
+                if (!(byte & 0x80)) {
+                    return value;
+                }
+            }
+
+            this->failed = true;
+
+            return 0;
+        }
+
+        uint8_t byte() {
+
+            if (this->at >= this->length) {
+
+                this->failed = true;
+
+                return 0;
+            }
+
+            return this->data[this->at++];
+        }
+};
+
+// palette is rgb per index
+static bool read_recording(const char* path, std::vector<uint8_t>& palette, std::vector<RecordedMaze>& mazes) {
+
+    FILE* file = fopen(path, "rb");
+
+    if (!file) {
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    uint8_t              chunk[1 << 16];
+    size_t               read;
+
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + read);
+    }
+
+    fclose(file);
+
+    if (data.size() < 8 || memcmp(data.data(), RECORDING_MAGIC, 8) != 0) {
+        return false;
+    }
+
+    RecordingReader in = {data.data(), data.size(), 8, false};
+
+    palette.assign(256 * 3, 0);
+
+    int lastIndex = 0;
+
+    while (in.at < in.length && !in.failed) {
+
+        uint64_t head = in.varint();
+
+        switch (head & 3) {
+
+        case RECORD_CELL: {
+
+            if (mazes.empty()) {
+                return false;
+            }
+
+            RecordedMaze& maze = mazes.back();
+
+            int64_t index = lastIndex + unzigzag(head >> 2);
+
+            if (index < 0 || index >= (int64_t)maze.walls.size()) {
+                return false;
+            }
+
+            maze.events.push_back({(int)index, in.byte()});
+
+            lastIndex = (int)index;
+
+            break;
+        }
+
+        case RECORD_PALETTE: {
+
+            uint8_t index = in.byte();
+
+            palette[index * 3 + 0] = in.byte();
+            palette[index * 3 + 1] = in.byte();
+            palette[index * 3 + 2] = in.byte();
+
+            break;
+        }
+
+        case RECORD_MAZE: {
+
+            RecordedMaze maze;
+
+            maze.width  = (int)in.varint();
+            maze.height = (int)in.varint();
+
+            size_t cells = (size_t)maze.width * maze.height;
+
+            if (maze.width <= 0 || maze.height <= 0 || in.length - in.at < cells * 2) {
+                return false;
+            }
+
+            maze.walls.resize(cells);
+            maze.colors.resize(cells);
+
+            for (size_t i = 0; i < cells; i++) {
+                maze.walls[i]  = in.byte();
+                maze.colors[i] = in.byte();
+            }
+
+            mazes.push_back(std::move(maze));
+
+            lastIndex = 0;
+
+            break;
+        }
+
+        default:
+            return false;
+        }
+    }
+
+    return !in.failed && !mazes.empty();
+}
+
+// full range rgb to bt.601 limited range yuv, one plane after the other
+static void rgb_to_yuv444(const uint8_t* rgb, size_t pixels, uint8_t* yuv) {
+
+    uint8_t* y = yuv;
+    uint8_t* u = yuv + pixels;
+    uint8_t* v = yuv + pixels * 2;
+
+    for (size_t i = 0; i < pixels; i++, rgb += 3) {
+
+        int r = rgb[0];
+        int g = rgb[1];
+        int b = rgb[2];
+
+        y[i] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        u[i] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        v[i] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+}
+
+bool RecordingEncoder::encode(const char* recording, const char* out) {
+
+    std::vector<uint8_t>      palette;
+    std::vector<RecordedMaze> mazes;
+
+    if (!read_recording(recording, palette, mazes)) {
+        return false;
+    }
+
+    size_t length = strlen(out);
+    bool   y4m    = length >= 4 && strcasecmp(out + length - 4, ".y4m") == 0;
+
+    int maxSide = 0;
+
+    for (RecordedMaze& maze : mazes) {
+
+        maxSide = std::max({maxSide, maze.width, maze.height});
+
+        // a video can't change size halfway through
+        if (y4m && (maze.width != mazes[0].width || maze.height != mazes[0].height)) {
+            return false;
+        }
+    }
+
+    int cellSize  = this->cellSize;
+    int wallWidth = this->wallWidth;
+
+    if (maxSide * cellSize > ENCODE_MAX_SIDE) {
+
+        cellSize  = std::max(ENCODE_MAX_SIDE / maxSide, 1);
+        wallWidth = this->wallWidth * cellSize / this->cellSize;
+    }
+
+    std::vector<RecordedFrame> frames;
+
+    for (size_t m = 0; m < mazes.size(); m++) {
+
+        size_t events = mazes[m].events.size();
+        size_t step   = this->frameEvents > 0 ? this->frameEvents : events / ENCODE_DEFAULT_FRAMES + 1;
+
+        for (size_t e = 0; e < events; e += step) {
+            frames.push_back({(int)m, e});
+        }
+
+        frames.push_back({(int)m, events});
+    }
+
+    int    width     = mazes[0].width * cellSize;
+    int    height    = mazes[0].height * cellSize;
+    size_t pixels    = (size_t)width * height;
+    size_t frameSize = 6 + pixels * 3;
+
+    FILE* video  = nullptr;
+    long  header = 0;
+
+    if (y4m) {
+
+        video = fopen(out, "wb");
+
+        if (!video) {
+            return false;
+        }
+
+        header = fprintf(video, "YUV4MPEG2 W%d H%d F30:1 Ip A1:1 C444\n", width, height);
+
+        fflush(video);
+    }
+
+    int threads = this->threads > 0 ? this->threads : std::max((int)std::thread::hardware_concurrency(), 1);
+    int perThread = (int)((frames.size() + threads - 1) / threads);
+
+    std::vector<std::thread> workers;
+    std::vector<char>        failed(threads, 0);
+
+    for (int t = 0; t * perThread < (int)frames.size(); t++) {
+
+        workers.emplace_back([&, t]() {
+
+            std::vector<Cell> cells;
+            std::vector<uint8_t> rgb;
+            std::vector<uint8_t> yuv;
+
+            Map map     = {};
+            int current = -1;
+
+            size_t applied = 0;
+
+            Snapshot snapshot = {
+                .map       = &map,
+                .player    = nullptr,
+                .cellSize  = cellSize,
+                .wallWidth = wallWidth,
+                .threads   = 1,
+                .stripRows = 0,
+                .palette   = palette.data(),
+            };
+
+            size_t last = std::min(frames.size(), (size_t)(t + 1) * perThread);
+
+            for (size_t f = (size_t)t * perThread; f < last && !failed[t]; f++) {
+
+                RecordedFrame& frame = frames[f];
+                RecordedMaze&  maze  = mazes[frame.maze];
+
+                if (frame.maze != current) {
+
+                    cells.assign(maze.walls.size(), {});
+
+                    for (size_t i = 0; i < cells.size(); i++) {
+
+                        for (int d = 0; d < 4; d++) {
+                            cells[i].walls[d] = maze.walls[i] >> d & 1;
+                        }
+
+                        cells[i].state = maze.colors[i];
+                    }
+
+                    map.cells  = cells.data();
+                    map.width  = maze.width;
+                    map.height = maze.height;
+
+                    current = frame.maze;
+                    applied = 0;
+                }
+
+                for (; applied < frame.events; applied++) {
+                    cells[maze.events[applied].index].state = maze.events[applied].color;
+                }
+
+                if (!y4m) {
+
+                    char path[4096];
+
+                    snprintf(path, sizeof(path), out, (int)f);
+
+                    failed[t] = !snapshot.write(path);
+
+                    continue;
+                }
+
+                rgb.resize(pixels * 3);
+                yuv.resize(frameSize);
+
+                snapshot.rasterize(rgb.data(), 0, height);
+
+                memcpy(yuv.data(), "FRAME\n", 6);
+
+                rgb_to_yuv444(rgb.data(), pixels, yuv.data() + 6);
+
+                // every frame is the same size, so each one knows where it goes
+                failed[t] = pwrite(fileno(video), yuv.data(), frameSize, header + f * frameSize) != (ssize_t)frameSize;
+            }
+        });
+    }
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    bool ok = std::find(failed.begin(), failed.end(), 1) == failed.end();
+
+    if (video) {
+        ok = fclose(video) == 0 && header > 0 && ok;
+    }
+
+    return ok;
+}
@@ -0,0 +1,50 @@
+
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+struct Map;
+
+// Writes solver progress as a stream of cell state changes instead of frames.
+// The file starts with a magic and holds a run of records, each led by a varint whose low two
+// bits give its kind:
+//   RECORD_CELL    the rest is the zigzagged distance from the previous changed cell, then a palette index
+//   RECORD_PALETTE a palette index and the rgb it stands for, sent the first time a state shows up
+//   RECORD_MAZE    a new maze: width, height, then per cell its wall bits and palette index
+// Palette indices are the CellState values, with their cellPalette colors at the time.
+// Attach one to Map::recorder and every setState and rebuild ends up in the file.
+struct Recorder {
+
+        FILE*                file;
+        std::vector<uint8_t> buffer;
+        uint32_t             sentStates; // a bit per state whose palette record is out
+        int                  lastIndex;
+
+        bool begin(const char* path);
+        void beginMaze(Map& map);
+        void cellChanged(int index, uint8_t state);
+        bool end();
+
+        uint8_t paletteIndex(uint8_t state);
+        void    putVarint(uint64_t value);
+        void    flush(size_t threshold);
+};
+
+// Turns a recording into a numbered png sequence, or a single y4m video when out ends in .y4m.
+// Every frame after the first of each maze adds frameEvents changes. Frames are split into
+// contiguous runs, one per thread, each replaying up to its first frame on its own.
+struct RecordingEncoder {
+
+        int cellSize;
+        int wallWidth;
+        int frameEvents; // 0 picks about 300 frames per maze
+        int threads;     // 0 picks one per core
+
+        // out is a printf pattern for png frames (frame_%06d.png) or a .y4m path
+        bool encode(const char* recording, const char* out);
+};
+
+#endif
@@ -0,0 +1,193 @@
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <strings.h>
+#include <thread>
+#include <vector>
+#include "../taskPool.hpp"
+#include "../world.hpp"
+#include "pngWriter.hpp"
+#include "snapshot.hpp"
+
+// rows rasterized per strip, the whole strip is in memory at once
+constexpr int SNAPSHOT_STRIP_ROWS = 256;
+
+static void to_rgb(uint8_t* out, gl2d::Color4f color) {
+
+    out[0] = (uint8_t)(std::clamp(color.r, 0.0f, 1.0f) * 255.0f + 0.5f);
+    out[1] = (uint8_t)(std::clamp(color.g, 0.0f, 1.0f) * 255.0f + 0.5f);
+    out[2] = (uint8_t)(std::clamp(color.b, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+static void fill(uint8_t* out, int count, const uint8_t* rgb) {
+
+    for (int i = 0; i < count; i++, out += 3) {
+        out[0] = rgb[0];
+        out[1] = rgb[1];
+        out[2] = rgb[2];
+    }
+}
+
+// rows of pixels starting at image row firstRow, tightly packed rgb
+void Snapshot::rasterize(uint8_t* rgb, int firstRow, int rowCount) {
+
+    int    cellSize = this->cellSize;
+    size_t stride   = (size_t)this->map->width * cellSize * 3;
+
+    uint8_t wall[3];
+    uint8_t player[3];
+    uint8_t states[CELL_STATE_COUNT][3];
+
+    to_rgb(wall, ColorWall);
+    to_rgb(player, ColorPlayer);
+
+    const uint8_t* palette = this->palette;
+
+    if (!palette) {
+
+        for (int s = 0; s < CELL_STATE_COUNT; s++) {
+            to_rgb(states[s], cellPalette[s]);
+        }
+
+        palette = states[0];
+    }
+
+    for (int r = 0; r < rowCount; r++) {
+
+        int y     = (firstRow + r) / cellSize;
+        int inner = (firstRow + r) % cellSize;
+
+        uint8_t* out = rgb + stride * r;
+
+        for (int x = 0; x < this->map->width; x++, out += cellSize * 3) {
+
+            Cell* cell = this->map->at(x, y);
+
+            // the player is drawn over the cell, walls and all
+            if (this->player && this->player->x == x && this->player->y == y) {
+
+                fill(out, cellSize, player);
+
+                continue;
+            }
+
+            bool north = cell->walls[Direction::NORTH] && inner < this->wallWidth;
+            bool south = cell->walls[Direction::SOUTH] && inner >= cellSize - this->wallWidth;
+
+            if (north || south) {
+
+                fill(out, cellSize, wall);
+
+                continue;
+            }
+
+            const uint8_t* color = palette + cell->state * 3;
+
+            int west = cell->walls[Direction::WEST] ? std::min(this->wallWidth, cellSize) : 0;
+            int east = cell->walls[Direction::EAST] ? std::max(cellSize - this->wallWidth, west) : cellSize;
+
+            fill(out, west, wall);
+            fill(out + west * 3, east - west, color);
+            fill(out + east * 3, cellSize - east, wall);
+        }
+    }
+}
+
+bool Snapshot::write(const char* path) {
+
+    int width  = this->map->width * this->cellSize;
+    int height = this->map->height * this->cellSize;
+
+    int threads   = this->threads > 0 ? this->threads : std::max((int)std::thread::hardware_concurrency(), 1);
+    int stripRows = this->stripRows > 0 ? this->stripRows : SNAPSHOT_STRIP_ROWS;
+
+    size_t length = strlen(path);
+    bool   png    = length >= 4 && strcasecmp(path + length - 4, ".png") == 0;
+
+    size_t stride = (size_t)width * 3;
+
+    // one extra row in front keeps the last row of the previous strip around for the png up filter
+    std::vector<uint8_t> strip(stride * (stripRows + 1));
+    std::vector<PngBand> bands(threads);
+
+    PngWriter writer;
+    FILE*     ppm = nullptr;
+    bool      ok  = true;
+
+    if (png) {
+
+        if (!writer.begin(path, width, height)) {
+            return false;
+        }
+
+    } else {
+
+        ppm = fopen(path, "wb");
+
+        if (!ppm) {
+            return false;
+        }
+
+        ok = fprintf(ppm, "P6\n%d %d\n255\n", width, height) > 0;
+    }
+
+    // the same threads do every strip, a band each
+    TaskPool<int> pool;
+
+    pool.start(threads);
+
+    std::vector<int> bandIndices;
+
+    for (int y = 0; y < height && ok; y += stripRows) {
+
+        int rows = std::min(stripRows, height - y);
+
+        int bandRows = (rows + threads - 1) / threads;
+        int count    = (rows + bandRows - 1) / bandRows;
+
+        bandIndices.resize(count);
+
+        for (int band = 0; band < count; band++) {
+            bandIndices[band] = band;
+        }
+
+        uint8_t* first = &strip[stride];
+
+        pool.run(bandIndices, [&](const int& band, int) {
+
+            int row = band * bandRows;
+
+            this->rasterize(first + stride * row, y + row, std::min(bandRows, rows - row));
+        });
+
+        if (png) {
+
+            // bands look at the row above them, so only start once every band is rasterized
+            pool.run(bandIndices, [&](const int& band, int) {
+
+                int      row   = band * bandRows;
+                uint8_t* above = y + row > 0 ? first + stride * (row - 1) : nullptr;
+
+                bands[band].encode(first + stride * row, above, width, std::min(bandRows, rows - row));
+            });
+
+            for (int band = 0; band < count && ok; band++) {
+                ok = writer.writeBand(bands[band]);
+            }
+
+            memcpy(strip.data(), first + stride * (rows - 1), stride);
+
+        } else {
+            ok = fwrite(first, 1, stride * rows, ppm) == stride * rows;
+        }
+    }
+
+    pool.stop();
+
+    if (png) {
+        return writer.end() && ok;
+    }
+
+    return fclose(ppm) == 0 && ok;
+}
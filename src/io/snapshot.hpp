@@ -0,0 +1,32 @@
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+
+struct Map;
+struct Player;
+
+// Draws the map and player into an image on the cpu, laid out exactly like World::renderMap,
+// so a maze can be saved without a window or a gl context.
+// The image goes out in strips of rows with each strip split into bands rasterized (and for png
+// compressed) on a TaskPool kept for the whole image, only a strip is ever held in memory.
+struct Snapshot {
+
+        Map*    map;
+        Player* player; // may be null
+        int     cellSize;
+        int     wallWidth;
+        int     threads;   // 0 picks one per core
+        int     stripRows; // 0 picks a default
+
+        // rgb per Cell::state, null for cellPalette
+        const uint8_t* palette;
+
+        // png when the path ends in .png, binary ppm otherwise
+        bool write(const char* path);
+
+        void rasterize(uint8_t* rgb, int firstRow, int rowCount);
+};
+
+#endif
@@ -0,0 +1,205 @@
+
+#include <cerrno>
+#include <cstring>
+#include <strings.h>
+#include <unistd.h>
+#include "textExport.hpp"
+
+// the buffer goes to write() once it holds this much
+constexpr size_t TEXT_FLUSH_SIZE = 1 << 20;
+
+// room past the flush size so a whole cell or row end always fits before checking
+constexpr size_t TEXT_SLACK = 64;
+
+void TextWriter::begin(int fd) {
+
+    this->fd     = fd;
+    this->used   = 0;
+    this->failed = false;
+
+    this->buffer.resize(TEXT_FLUSH_SIZE + TEXT_SLACK);
+}
+
+bool TextWriter::end() {
+
+    this->flush();
+
+    return !this->failed;
+}
+
+void TextWriter::flush() {
+
+    const char* data = this->buffer.data();
+    size_t      left = this->used;
+
+    while (left > 0 && !this->failed) {
+
+        ssize_t written = write(this->fd, data, left);
+
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (written <= 0) {
+
+            this->failed = true;
+
+            break;
+        }
+
+        data += written;
+        left -= written;
+    }
+
+    this->used = 0;
+}
+
+void TextWriter::put(char c) {
+
+    this->buffer[this->used++] = c;
+
+    if (this->used >= TEXT_FLUSH_SIZE) {
+        this->flush();
+    }
+}
+
+void TextWriter::put(const char* text, size_t length) {
+
+    for (size_t i = 0; i < length; i++) {
+        this->put(text[i]);
+    }
+}
+
+void TextWriter::putInt(int value, int width) {
+
+    // digits come out backwards, widest int plus a sign is 11 characters
+    char     digits[12];
+    int      count    = 0;
+    bool     negative = value < 0;
+    unsigned rest     = negative ? 0u - (unsigned)value : (unsigned)value;
+
+    do {
+        digits[count++] = (char)('0' + rest % 10);
+        rest /= 10;
+    } while (rest > 0);
+
+    if (negative) {
+        digits[count++] = '-';
+    }
+
+    for (int i = count; i < width; i++) {
+        this->buffer[this->used++] = ' ';
+    }
+
+    while (count > 0) {
+        this->buffer[this->used++] = digits[--count];
+    }
+
+    if (this->used >= TEXT_FLUSH_SIZE) {
+        this->flush();
+    }
+}
+
+static void put_ascii_row(TextWriter& out, Map& map, int y) {
+
+    // the north walls of the row, then the cells with their west walls
+    for (int x = 0; x < map.width; x++) {
+
+        out.put('+');
+        out.put(map.at(x, y)->walls[NORTH] ? "--" : "  ", 2);
+    }
+
+    out.put("+\n", 2);
+
+    for (int x = 0; x < map.width; x++) {
+
+        Cell* cell = map.at(x, y);
+
+        out.put(cell->walls[WEST] ? '|' : ' ');
+
+        if (cell->state == CELL_PATH) {
+            out.put("**", 2);
+        } else if (cell->state == CELL_SEARCHED) {
+            out.put("..", 2);
+        } else {
+            out.put("  ", 2);
+        }
+    }
+
+    out.put(map.at(map.width - 1, y)->walls[EAST] ? '|' : ' ');
+    out.put('\n');
+}
+
+bool export_text(int fd, Map& map, TextFormat format) {
+
+    TextWriter out;
+
+    out.begin(fd);
+
+    for (int y = 0; y < map.height && !out.failed; y++) {
+
+        switch (format) {
+
+        case TEXT_DISTANCES:
+
+            for (int x = 0; x < map.width; x++) {
+
+                out.putInt(map.at(x, y)->distance, 4);
+                out.put(' ');
+            }
+
+            out.put('\n');
+
+            break;
+
+        case TEXT_CSV:
+
+            for (int x = 0; x < map.width; x++) {
+
+                if (x > 0) {
+                    out.put(',');
+                }
+
+                out.putInt(map.at(x, y)->distance, 0);
+            }
+
+            out.put('\n');
+
+            break;
+
+        case TEXT_ASCII:
+
+            put_ascii_row(out, map, y);
+
+            break;
+        }
+    }
+
+    if (format == TEXT_ASCII) {
+
+        for (int x = 0; x < map.width; x++) {
+
+            out.put('+');
+            out.put(map.at(x, map.height - 1)->walls[SOUTH] ? "--" : "  ", 2);
+        }
+
+        out.put("+\n", 2);
+    }
+
+    return out.end();
+}
+
+TextFormat text_format_for(const char* path) {
+
+    size_t length = strlen(path);
+
+    if (length >= 4 && strcasecmp(path + length - 4, ".csv") == 0) {
+        return TEXT_CSV;
+    }
+
+    if (length >= 4 && strcasecmp(path + length - 4, ".txt") == 0) {
+        return TEXT_ASCII;
+    }
+
+    return TEXT_DISTANCES;
+}
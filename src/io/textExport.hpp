@@ -0,0 +1,38 @@
+
+#ifndef TEXT_EXPORT_H
+#define TEXT_EXPORT_H
+
+#include <cstddef>
+#include <vector>
+#include "../world.hpp"
+
+typedef enum {
+    TEXT_DISTANCES, // the distance table the I key prints, 4 wide columns
+    TEXT_CSV,       // distances, comma separated
+    TEXT_ASCII,     // walls drawn with +, - and |, the path as * and searched cells as .
+} TextFormat;
+
+// Formats into one reusable buffer and hands it to write() about once per megabyte,
+// so dumping ten million cells costs a few syscalls and no allocations per cell.
+struct TextWriter {
+
+        int               fd;
+        std::vector<char> buffer;
+        size_t            used;
+        bool              failed;
+
+        void begin(int fd);
+        bool end();
+
+        void put(char c);
+        void put(const char* text, size_t length);
+        void putInt(int value, int width); // right aligned in width columns
+        void flush();
+};
+
+bool export_text(int fd, Map& map, TextFormat format);
+
+// picks the format from the extension of path, .csv or .txt (ascii art), otherwise the distance table
+TextFormat text_format_for(const char* path);
+
+#endif
@@ -0,0 +1,497 @@
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "tileArchive.hpp"
+
+// probabilities are 11 bit fixed point and move 1/32 of the way towards each bit seen
+constexpr int      PROB_BITS  = 11;
+constexpr int      PROB_SHIFT = 5;
+constexpr uint32_t RANGE_TOP  = 1 << 24;
+
+// contexts per wall kind, three neighbouring wall bits each
+constexpr int WALL_CONTEXTS = 8;
+
+struct WallModel {
+
+        uint16_t edge[2]; // top and left edge bits, by the previous bit on the edge
+        uint16_t south[WALL_CONTEXTS];
+        uint16_t east[WALL_CONTEXTS];
+
+        void reset() {
+            std::fill(this->edge, this->edge + 2, 1 << (PROB_BITS - 1));
+            std::fill(this->south, this->south + WALL_CONTEXTS, 1 << (PROB_BITS - 1));
+            std::fill(this->east, this->east + WALL_CONTEXTS, 1 << (PROB_BITS - 1));
+        }
+};
+
+// binary range coder, the same scheme lzma uses
+struct RangeEncoder {
+
+        std::vector<uint8_t>& out;
+        uint64_t              low;
+        uint32_t              range;
+        uint8_t               cache;
+        uint64_t              cacheSize;
+
+        void shiftLow() {
+
+            if ((uint32_t)this->low < 0xff000000u || (this->low >> 32) != 0) {
+
+                uint8_t carry = (uint8_t)(this->low >> 32);
+                uint8_t temp  = this->cache;
+
+                do {
+                    this->out.push_back(temp + carry);
+                    temp = 0xff;
+                } while (--this->cacheSize != 0);
+
+                this->cache = (uint8_t)(this->low >> 24);
+            }
+
+            this->cacheSize++;
+            this->low = (this->low & 0x00ffffff) << 8;
+        }
+
+        void encode(uint16_t& prob, int bit) {
+
+            uint32_t bound = (this->range >> PROB_BITS) * prob;
+
+            if (bit) {
+                this->low += bound;
+                this->range -= bound;
+                prob -= prob >> PROB_SHIFT;
+            } else {
+                this->range = bound;
+                prob += ((1 << PROB_BITS) - prob) >> PROB_SHIFT;
+            }
+
+            while (this->range < RANGE_TOP) {
+                this->range <<= 8;
+                this->shiftLow();
+            }
+        }
+
+        void finish() {
+
+            for (int i = 0; i < 5; i++) {
+                this->shiftLow();
+            }
+        }
+};
+
+struct RangeDecoder {
+
+        const uint8_t* in;
+        const uint8_t* end;
+        uint32_t       range;
+        uint32_t       code;
+
+        // reading past the end gives zeros, a broken tile decodes to garbage but never crashes
+        uint8_t next() {
+            return this->in < this->end ? *this->in++ : 0;
+        }
+
+        void start() {
+
+            this->range = 0xffffffff;
+            this->code  = 0;
+
+            for (int i = 0; i < 5; i++) {
+                this->code = this->code << 8 | this->next();
+            }
+        }
+
+        int decode(uint16_t& prob) {
+
+            uint32_t bound = (this->range >> PROB_BITS) * prob;
+            int      bit;
+
+            if (this->code < bound) {
+                this->range = bound;
+                prob += ((1 << PROB_BITS) - prob) >> PROB_SHIFT;
+                bit = 0;
+            } else {
+                this->code -= bound;
+                this->range -= bound;
+                prob -= prob >> PROB_SHIFT;
+                bit = 1;
+            }
+
+            while (this->range < RANGE_TOP) {
+                this->range <<= 8;
+                this->code = this->code << 8 | this->next();
+            }
+
+            return bit;
+        }
+};
+
+// the context of a cell's south wall: its north and west walls and the south wall of its west neighbour
+static int south_context(const uint8_t* walls, int i, int x) {
+
+    int west = x > 0 ? walls[i - 1] >> SOUTH & 1 : 1;
+
+    return (walls[i] >> NORTH & 1) | (walls[i] >> WEST & 1) << 1 | west << 2;
+}
+
+// the context of a cell's east wall: its north and south walls and the east wall of its north neighbour
+static int east_context(const uint8_t* walls, int tw, int i, int y) {
+
+    int north = y > 0 ? walls[i - tw] >> EAST & 1 : 1;
+
+    return (walls[i] >> NORTH & 1) | (walls[i] >> SOUTH & 1) << 1 | north << 2;
+}
+
+// walls is tw * th cells of 1 << Direction bits, only the edge north and west bits and every
+// south and east bit are coded, the rest follows from them
+template <typename Coder> static void code_tile(Coder& coder, uint8_t* walls, int tw, int th) {
+
+    WallModel model;
+
+    model.reset();
+
+    int prev = 1;
+
+    for (int x = 0; x < tw; x++) {
+
+        int bit = coder(model.edge[prev], walls[x] >> NORTH & 1);
+
+        walls[x] = (walls[x] & ~(1 << NORTH)) | bit << NORTH;
+        prev     = bit;
+    }
+
+    prev = 1;
+
+    for (int y = 0; y < th; y++) {
+
+        int bit = coder(model.edge[prev], walls[y * tw] >> WEST & 1);
+
+        walls[y * tw] = (walls[y * tw] & ~(1 << WEST)) | bit << WEST;
+        prev          = bit;
+    }
+
+    for (int y = 0; y < th; y++) {
+
+        for (int x = 0; x < tw; x++) {
+
+            int i = y * tw + x;
+
+            // inside the tile north and west are the neighbours' south and east
+            if (y > 0) {
+                walls[i] = (walls[i] & ~(1 << NORTH)) | (walls[i - tw] >> SOUTH & 1) << NORTH;
+            }
+
+            if (x > 0) {
+                walls[i] = (walls[i] & ~(1 << WEST)) | (walls[i - 1] >> EAST & 1) << WEST;
+            }
+
+            int south = coder(model.south[south_context(walls, i, x)], walls[i] >> SOUTH & 1);
+
+            walls[i] = (walls[i] & ~(1 << SOUTH)) | south << SOUTH;
+
+            int east = coder(model.east[east_context(walls, tw, i, y)], walls[i] >> EAST & 1);
+
+            walls[i] = (walls[i] & ~(1 << EAST)) | east << EAST;
+        }
+    }
+}
+
+static void tile_extent(const TileArchiveHeader& header, int tileX, int tileY, int& tw, int& th) {
+
+    tw = std::min((int)header.tileSize, (int)header.width - tileX * header.tileSize);
+    th = std::min((int)header.tileSize, (int)header.height - tileY * header.tileSize);
+}
+
+bool save_tile_archive(const char* path, Map& map, int tileSize) {
+
+    TileArchiveHeader header = {};
+
+    memcpy(header.magic, "MZTL", 4);
+
+    header.version   = TILE_ARCHIVE_VERSION;
+    header.tileSize  = tileSize;
+    header.width     = map.width;
+    header.height    = map.height;
+    header.finishX   = map.finishPos.x;
+    header.finishY   = map.finishPos.y;
+    header.generator = map.generator;
+    header.seed      = map.seed;
+    header.tilesX    = (map.width + tileSize - 1) / tileSize;
+    header.tilesY    = (map.height + tileSize - 1) / tileSize;
+
+    FILE* file = fopen(path, "wb");
+
+    if (!file) {
+        return false;
+    }
+
+    // the header goes out again at the end, once the index offset is known
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    std::vector<TileIndexEntry> index(header.tilesX * header.tilesY);
+    std::vector<uint8_t>        walls;
+    std::vector<uint8_t>        data;
+
+    uint64_t offset = sizeof(header);
+
+    for (uint32_t ty = 0; ty < header.tilesY && ok; ty++) {
+
+        for (uint32_t tx = 0; tx < header.tilesX && ok; tx++) {
+
+            int tw, th;
+
+            tile_extent(header, tx, ty, tw, th);
+
+            walls.resize(tw * th);
+
+            for (int y = 0; y < th; y++) {
+
+                for (int x = 0; x < tw; x++) {
+
+                    Cell* cell = map.at(tx * tileSize + x, ty * tileSize + y);
+
+                    walls[y * tw + x] = 0;
+
+                    for (int d = 0; d < 4; d++) {
+                        walls[y * tw + x] |= cell->walls[d] << d;
+                    }
+                }
+            }
+
+            data.clear();
+
+            RangeEncoder encoder = {data, 0, 0xffffffff, 0, 1};
+
+            auto coder = [&encoder](uint16_t& prob, int bit) {
+
+                encoder.encode(prob, bit);
+
+                return bit;
+            };
+
+            code_tile(coder, walls.data(), tw, th);
+
+            encoder.finish();
+
+            index[ty * header.tilesX + tx] = {offset, (uint32_t)data.size(), 0};
+
+            offset += data.size();
+
+            ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+        }
+    }
+
+    header.indexOffset = offset;
+
+    ok = ok && fwrite(index.data(), sizeof(TileIndexEntry), index.size(), file) == index.size();
+    ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+
+    return fclose(file) == 0 && ok;
+}
+
+bool TiledMaze::open(const char* path, size_t cacheTiles) {
+
+    this->fd = ::open(path, O_RDONLY);
+
+    if (this->fd < 0) {
+        return false;
+    }
+
+    this->cacheTiles = std::max(cacheTiles, (size_t)1);
+
+    this->lru.clear();
+    this->cache.clear();
+
+    TileArchiveHeader& h = this->header;
+
+    struct stat info;
+
+    bool ok = fstat(this->fd, &info) == 0 && pread(this->fd, &h, sizeof(h), 0) == sizeof(h) &&
+              memcmp(h.magic, "MZTL", 4) == 0 && h.version == TILE_ARCHIVE_VERSION && h.tileSize > 0;
+
+    // a broken header must not index past the maze or the file
+    ok = ok && h.width > 0 && h.height > 0 && h.width <= INT_MAX && h.height <= INT_MAX;
+    ok = ok && h.finishX >= 0 && (uint32_t)h.finishX < h.width && h.finishY >= 0 && (uint32_t)h.finishY < h.height;
+
+    ok = ok && h.tilesX == (h.width + h.tileSize - 1) / h.tileSize;
+    ok = ok && h.tilesY == (h.height + h.tileSize - 1) / h.tileSize;
+
+    size_t size  = ok ? (size_t)info.st_size : 0;
+    size_t tiles = (size_t)h.tilesX * h.tilesY;
+
+    ok = ok && h.indexOffset <= size && tiles <= (size - h.indexOffset) / sizeof(TileIndexEntry);
+
+    if (ok) {
+
+        this->index.resize(tiles);
+
+        ssize_t bytes = this->index.size() * sizeof(TileIndexEntry);
+
+        ok = pread(this->fd, this->index.data(), bytes, h.indexOffset) == bytes;
+    }
+
+    if (!ok) {
+        this->close();
+    }
+
+    return ok;
+}
+
+void TiledMaze::close() {
+
+    if (this->fd >= 0) {
+        ::close(this->fd);
+    }
+
+    this->fd = -1;
+
+    this->index.clear();
+    this->lru.clear();
+    this->cache.clear();
+}
+
+const uint8_t* TiledMaze::tile(int tileX, int tileY) {
+
+    int id = tileY * this->header.tilesX + tileX;
+
+    auto found = this->cache.find(id);
+
+    if (found != this->cache.end()) {
+
+        this->lru.splice(this->lru.begin(), this->lru, found->second.used);
+
+        return found->second.walls.data();
+    }
+
+    TileIndexEntry& entry = this->index[id];
+
+    std::vector<uint8_t> data(entry.length);
+
+    if (pread(this->fd, data.data(), entry.length, entry.offset) != (ssize_t)entry.length) {
+        return nullptr;
+    }
+
+    if (this->cache.size() >= this->cacheTiles) {
+
+        this->cache.erase(this->lru.back());
+        this->lru.pop_back();
+    }
+
+    int tw, th;
+
+    tile_extent(this->header, tileX, tileY, tw, th);
+
+    this->lru.push_front(id);
+
+    CachedTile& cached = this->cache[id];
+
+    cached.used = this->lru.begin();
+    cached.walls.assign(tw * th, 0);
+
+    RangeDecoder decoder = {data.data(), data.data() + data.size()};
+
+    decoder.start();
+
+    auto coder = [&decoder](uint16_t& prob, int) {
+        return decoder.decode(prob);
+    };
+
+    code_tile(coder, cached.walls.data(), tw, th);
+
+    return cached.walls.data();
+}
+
+bool TiledMaze::wallAt(int x, int y, Direction d) {
+
+    int size = this->header.tileSize;
+
+    const uint8_t* walls = this->tile(x / size, y / size);
+
+    if (!walls) {
+        return true;
+    }
+
+    int tw, th;
+
+    tile_extent(this->header, x / size, y / size, tw, th);
+
+    return walls[(y % size) * tw + x % size] >> d & 1;
+}
+
+bool TiledMaze::readRegion(int x, int y, int w, int h, Cell* out) {
+
+    if (x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > (int)this->header.width || y + h > (int)this->header.height) {
+        return false;
+    }
+
+    int size = this->header.tileSize;
+
+    for (int ty = y / size; ty <= (y + h - 1) / size; ty++) {
+
+        for (int tx = x / size; tx <= (x + w - 1) / size; tx++) {
+
+            const uint8_t* walls = this->tile(tx, ty);
+
+            if (!walls) {
+                return false;
+            }
+
+            int tw, th;
+
+            tile_extent(this->header, tx, ty, tw, th);
+
+            // the part of this tile inside the region, in map coordinates
+            int x0 = std::max(x, tx * size);
+            int y0 = std::max(y, ty * size);
+            int x1 = std::min(x + w, tx * size + tw);
+            int y1 = std::min(y + h, ty * size + th);
+
+            for (int cy = y0; cy < y1; cy++) {
+
+                for (int cx = x0; cx < x1; cx++) {
+
+                    uint8_t bits = walls[(cy - ty * size) * tw + cx - tx * size];
+                    Cell*   cell = out + (size_t)(cy - y) * w + cx - x;
+
+                    *cell = {.state = CELL_EMPTY, .visited = false, .distance = 0};
+
+                    for (int d = 0; d < 4; d++) {
+                        cell->walls[d] = bits >> d & 1;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool TiledMaze::toMap(Map& map) {
+
+    map.width     = this->header.width;
+    map.height    = this->header.height;
+    map.finishPos = {this->header.finishX, this->header.finishY};
+    map.generator = (Generator)this->header.generator;
+    map.seed      = this->header.seed;
+
+    // a band of tile rows at a time, every tile is decoded once whatever the cache size
+    for (int y = 0; y < map.height; y += this->header.tileSize) {
+
+        int rows = std::min((int)this->header.tileSize, map.height - y);
+
+        if (!this->readRegion(0, y, map.width, rows, map.cells + (size_t)y * map.width)) {
+            return false;
+        }
+    }
+
+    map.at(map.finishPos.x, map.finishPos.y)->state = CELL_FINISH;
+
+    map.mazeChanged();
+
+    return true;
+}
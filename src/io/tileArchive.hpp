@@ -0,0 +1,83 @@
+
+#ifndef TILE_ARCHIVE_H
+#define TILE_ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "../world.hpp"
+
+constexpr uint16_t TILE_ARCHIVE_VERSION = 1;
+
+// Layout of a tiled maze archive, native byte order like the plain maze file:
+//   the header below
+//   tile data, each tile compressed on its own
+//   the tile index, a TileIndexEntry per tile in row major tile order
+// A tile holds the walls of up to tileSize x tileSize cells and doesn't need its neighbours to
+// be read: its top row's north walls and left column's west walls are stored with it.
+// Wall bits are range coded with adaptive probabilities picked by the walls already seen
+// around each cell, which squeezes both long open or closed runs and maze structure.
+struct TileArchiveHeader {
+
+        char     magic[4]; // "MZTL"
+        uint16_t version;
+        uint16_t tileSize;
+        uint32_t width;
+        uint32_t height;
+        int32_t  finishX;
+        int32_t  finishY;
+        uint32_t generator;
+        uint32_t seed;
+        uint32_t tilesX;
+        uint32_t tilesY;
+        uint64_t indexOffset;
+};
+
+struct TileIndexEntry {
+
+        uint64_t offset;
+        uint32_t length;
+        uint32_t reserved;
+};
+
+bool save_tile_archive(const char* path, Map& map, int tileSize);
+
+// Reads a tile archive a tile at a time, keeping the most recently used tiles decoded.
+// Only the index is loaded up front, so wallAt and readRegion can walk mazes far bigger than
+// memory region by region. The app doesn't yet: it loads through toMap, which decodes every
+// tile into a full Cell array, since the solvers and renderers all work on Map::cells.
+struct TiledMaze {
+
+        struct CachedTile {
+
+                std::vector<uint8_t>     walls; // 1 << Direction bits per cell, row major in the tile
+                std::list<int>::iterator used;
+        };
+
+        int                         fd;
+        TileArchiveHeader           header;
+        std::vector<TileIndexEntry> index;
+
+        size_t                              cacheTiles;
+        std::list<int>                      lru; // most recently used first
+        std::unordered_map<int, CachedTile> cache;
+
+        bool open(const char* path, size_t cacheTiles);
+        void close();
+
+        // null when the tile can't be read
+        const uint8_t* tile(int tileX, int tileY);
+
+        bool wallAt(int x, int y, Direction d);
+
+        // copies a w x h block of cells starting at x, y into out, row major,
+        // only decoding the tiles it touches
+        bool readRegion(int x, int y, int w, int h, Cell* out);
+
+        // eager, map.cells needs room for the whole maze and every tile is decoded once
+        bool toMap(Map& map);
+};
+
+#endif
@@ -1,22 +1,51 @@
 
 
+#include <algorithm>
+#include <climits>
 #include <iostream>
 #include <ostream>
 #include <stack>
 #include <queue>
+#include <vector>
 
 #include <GLFW/glfw3.h>
 #include <gl2d/gl2d.h>
 #include <glad/glad.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include "glm/fwd.hpp"
 
+#include "io/mazeFile.hpp"
+#include "io/recording.hpp"
+#include "io/textExport.hpp"
+#include "io/tileArchive.hpp"
+#include "io/snapshot.hpp"
+#include "mazeBuilder.hpp"
+#include "openglErrorReporting.h"
+#include "simulation.hpp"
 #include "solvers/solvers.hpp"
+#include "trace.hpp"
 #include "world.hpp"
 
 constexpr size_t M_WIDTH = 12;
 constexpr size_t M_HEIGHT = 12;
 
+constexpr int CELL_SIZE  = 25;
+constexpr int WALL_WIDTH = 4;
+
+// cells per side of a tile in .tiles archives, and how many decoded tiles stay cached
+constexpr int    TILE_SIZE        = 256;
+constexpr size_t TILE_CACHE_TILES = 64;
+
+// longest we sleep waiting for input when nothing is animating
+constexpr double IDLE_WAIT = 1.0;
+
+// frame time the --budget solver budget adapts to hold
+constexpr double TARGET_FRAME_TIME = 1.0 / 60.0;
+
+// how often the solver stats in the window title are refreshed
+constexpr double TITLE_INTERVAL = 0.25;
+
 #define DIE(fmt, ...)                                                                                                  \
     do {                                                                                                               \
         fprintf(stderr, (fmt), ##__VA_ARGS__);                                                                         \
@@ -37,16 +66,24 @@ struct Args {
     int height;
     int percentLessWalls;
     int algo;
+    int vsync;
+    int threaded;
+    int steps;
+    int budget;
+    const char* snapshot;
+    const char* text;
+    const char* record;
+    const char* encode;
+    const char* out;
+    const char* save;
+    const char* load;
+    const char* trace;
+    int         seeded;
+    unsigned    seed;
+    int         glDebug;
+    Generator   generator;
 };
 
-std::string pad_left(std::string const& str, size_t s)
-{
-    if ( str.size() < s )
-        return std::string(s-str.size(), ' ') + str;
-    else
-        return str;
-}
-
 bool uDetachFromTerminal() {
 
     int pid = fork();
@@ -160,6 +197,161 @@ int handle_flags( Args& args, const char* flag_str, const char* flag_value) {
                         DIE("--height requires a height value > 0");
                 }
 
+                if (strcasecmp(flag_str + i, "-text") == 0) {
+
+                    DIE_IF_NULL(flag_value, "--text requires a path, - for stdout");
+
+                    args.text = flag_value;
+
+                    return 1;
+                }
+
+                if (strcasecmp(flag_str + i, "-gl-debug") == 0) {
+
+                    args.glDebug = 1;
+
+                    return 0;
+                }
+
+                if (strcasecmp(flag_str + i, "-trace") == 0) {
+
+                    DIE_IF_NULL(flag_value, "--trace requires a .json path");
+
+                    args.trace = flag_value;
+
+                    return 1;
+                }
+
+                if (strcasecmp(flag_str + i, "-save") == 0) {
+
+                    DIE_IF_NULL(flag_value, "--save requires a path");
+
+                    args.save = flag_value;
+
+                    return 1;
+                }
+
+                if (strcasecmp(flag_str + i, "-load") == 0) {
+
+                    DIE_IF_NULL(flag_value, "--load requires a path");
+
+                    args.load = flag_value;
+
+                    return 1;
+                }
+
+                if (strcasecmp(flag_str + i, "-seed") == 0) {
+
+                    DIE_IF_NULL(flag_value, "--seed requires a number");
+
+                    args.seeded = 1;
+                    args.seed   = strtoul(flag_value, NULL, 10);
+
+                    return 1;
+                }
+
+                if (strcasecmp(flag_str + i, "-record") == 0) {
+
+                    DIE_IF_NULL(flag_value, "--record requires a path");
+
+                    args.record = flag_value;
+
+                    return 1;
+                }
+
+                if (strcasecmp(flag_str + i, "-encode") == 0) {
+
+                    DIE_IF_NULL(flag_value, "--encode requires a recording path");
+
+                    args.encode = flag_value;
+
+                    return 1;
+                }
+
+                if (strcasecmp(flag_str + i, "-out") == 0) {
+
+                    DIE_IF_NULL(flag_value, "--out requires a frame pattern or .y4m path");
+
+                    args.out = flag_value;
+
+                    return 1;
+                }
+
+                if (strcasecmp(flag_str + i, "-snapshot") == 0) {
+
+                    DIE_IF_NULL(flag_value, "--snapshot requires a .png or .ppm path");
+
+                    args.snapshot = flag_value;
+
+                    return 1;
+                }
+
+                if (strcasecmp(flag_str + i, "-steps") == 0) {
+
+                    DIE_IF_NULL(flag_value, "--steps requires a step count > 0");
+
+                    args.steps = atoi(flag_value);
+
+                    if (args.steps <= 0)
+                        DIE("--steps requires a step count > 0");
+
+                    return 1;
+                }
+
+                if (strcasecmp(flag_str + i, "-budget") == 0) {
+
+                    DIE_IF_NULL(flag_value, "--budget requires microseconds > 0");
+
+                    args.budget = atoi(flag_value);
+
+                    if (args.budget <= 0)
+                        DIE("--budget requires microseconds > 0");
+
+                    return 1;
+                }
+
+                if (strcasecmp(flag_str + i, "-generator") == 0) {
+
+                    DIE_IF_NULL(
+                        flag_value, "--generator requires backtracker, division, binarytree, sidewinder or huntandkill"
+                    );
+
+                    if (strcasecmp(flag_value, "backtracker") == 0) {
+                        args.generator = GEN_BACKTRACKER;
+                    } else if (strcasecmp(flag_value, "division") == 0) {
+                        args.generator = GEN_DIVISION;
+                    } else if (strcasecmp(flag_value, "binarytree") == 0) {
+                        args.generator = GEN_BINARY_TREE;
+                    } else if (strcasecmp(flag_value, "sidewinder") == 0) {
+                        args.generator = GEN_SIDEWINDER;
+                    } else if (strcasecmp(flag_value, "huntandkill") == 0) {
+                        args.generator = GEN_HUNT_AND_KILL;
+                    } else {
+                        DIE("--generator requires backtracker, division, binarytree, sidewinder or huntandkill");
+                    }
+
+                    return 1;
+                }
+
+                if (strcasecmp(flag_str + i, "-threaded") == 0) {
+
+                    args.threaded = 1;
+
+                    return 0;
+                }
+
+                if (strcasecmp(flag_str + i, "-vsync") == 0) {
+
+                    DIE_IF_NULL(flag_value, "--vsync requires 0 or 1");
+
+                    args.vsync = atoi(flag_value);
+
+                    if (args.vsync < 0 || args.vsync > 1)
+                        DIE("--vsync requires 0 or 1");
+
+                    return 1;
+                }
+
                 return 0;
 
         case 'a':
@@ -173,6 +365,36 @@ int handle_flags( Args& args, const char* flag_str, const char* flag_value) {
 
             return 1;
 
+        case 'b':
+
+            DIE_IF_NULL(flag_value, "--budget requires microseconds > 0");
+
+            args.budget = atoi(flag_value);
+
+            if (args.budget <= 0)
+                DIE("--budget requires microseconds > 0");
+
+            return 1;
+
+        case 'e':
+
+            DIE_IF_NULL(flag_value, "--encode requires a recording path");
+
+            args.encode = flag_value;
+
+            return 1;
+
+        case 'k':
+
+            DIE_IF_NULL(flag_value, "--steps requires a step count > 0");
+
+            args.steps = atoi(flag_value);
+
+            if (args.steps <= 0)
+                DIE("--steps requires a step count > 0");
+
+            return 1;
+
         case 'l':
 
             DIE_IF_NULL(flag_value, "less-walls requires a number from 0-100");
@@ -184,6 +406,47 @@ int handle_flags( Args& args, const char* flag_str, const char* flag_value) {
 
             return 1;
 
+        case 'o':
+
+            DIE_IF_NULL(flag_value, "--out requires a frame pattern or .y4m path");
+
+            args.out = flag_value;
+
+            return 1;
+
+        case 'r':
+
+            DIE_IF_NULL(flag_value, "--record requires a path");
+
+            args.record = flag_value;
+
+            return 1;
+
+        case 's':
+
+            DIE_IF_NULL(flag_value, "--snapshot requires a .png or .ppm path");
+
+            args.snapshot = flag_value;
+
+            return 1;
+
+        case 't':
+
+            args.threaded = 1;
+
+            return 0;
+
+        case 'v':
+
+            DIE_IF_NULL(flag_value, "--vsync requires 0 or 1");
+
+            args.vsync = atoi(flag_value);
+
+            if (args.vsync < 0 || args.vsync > 1)
+                DIE("--vsync requires 0 or 1");
+
+            return 1;
+
         case 'w':
 
             DIE_IF_NULL(flag_value, "--width requires a width value > 0");
@@ -223,11 +486,135 @@ void handle_start_args(Args& config, int argc, char* argv[]) {
     }
 }
 
-int main(int argc, char* argv[]) {
+// the first maze comes from --load, then --seed, then rand
+void build_first_maze(Args& args, MazeView& loaded, TiledMaze& tiled, Map& map) {
 
-    uDetachFromTerminal();
+    if (args.load && loaded.base) {
+
+        loaded.toMap(map);
+
+        loaded.close();
+
+    } else if (args.load) {
+
+        if (!tiled.toMap(map))
+            DIE("could not read the tiles of %s", args.load);
+
+        tiled.close();
+
+    } else if (args.seeded) {
+        map.buildMaze(args.seed);
+    } else {
+        map.buildRandomMaze();
+    }
+}
+
+// solves a maze without opening a window, then writes whichever of --snapshot, --text and --save were given
+int run_headless(Args& args, MazeView& loaded, TiledMaze& tiled) {
+
+    std::vector<Cell> cells((size_t)args.width * args.height);
+
+    Player player = {.x = 0, .y = 0, .lastmoved = 0, .movecooldown = 0};
+
+    Map map = {
+        .cells = cells.data(),
+        .percentLessWalls = args.percentLessWalls,
+        .width = args.width,
+        .height = args.height,
+        .generator = args.generator,
+    };
+
+    Recorder recorder;
+
+    if (args.record) {
+
+        if (!recorder.begin(args.record))
+            DIE("could not record to %s", args.record);
+
+        map.recorder = &recorder;
+    }
+
+    build_first_maze(args, loaded, tiled, map);
+
+    Simulation sim = {.map = &map, .player = &player, .strategy = SolveStrat(args.algo)};
+
+    sim.restart();
+
+    sim.run(INT_MAX);
+
+    char stats[256];
+
+    sim.stats.format(stats, sizeof(stats), sim.strategy);
+
+    fprintf(stderr, "%dx%d %s\n", map.width, map.height, stats);
+
+    Snapshot snapshot = {
+        .map       = &map,
+        .player    = &player,
+        .cellSize  = CELL_SIZE,
+        .wallWidth = WALL_WIDTH,
+        .threads   = 0,
+        .stripRows = 0,
+        .palette   = nullptr,
+    };
 
-    Args args = {0, 0, 0, int(SolveStrat::FLOODFILL)};
+    if (args.snapshot && !snapshot.write(args.snapshot))
+        DIE("could not write snapshot to %s", args.snapshot);
+
+    if (args.text) {
+
+        bool toStdout = strcmp(args.text, "-") == 0;
+        int  fd       = toStdout ? STDOUT_FILENO : open(args.text, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        if (fd < 0 || !export_text(fd, map, text_format_for(args.text)))
+            DIE("could not write text to %s", args.text);
+
+        if (!toStdout)
+            close(fd);
+    }
+
+    if (args.save) {
+
+        size_t length = strlen(args.save);
+        bool   tiles  = length >= 6 && strcasecmp(args.save + length - 6, ".tiles") == 0;
+
+        if (tiles ? !save_tile_archive(args.save, map, TILE_SIZE) : !save_maze(args.save, map, true))
+            DIE("could not save maze to %s", args.save);
+    }
+
+    if (args.record && !recorder.end())
+        DIE("could not record to %s", args.record);
+
+    if (args.trace && !trace_dump(args.trace))
+        DIE("could not write trace to %s", args.trace);
+
+    return 0;
+}
+
+// turns a --record file into frames, see RecordingEncoder
+int run_encoder(Args& args) {
+
+    DIE_IF_NULL(args.out, "--encode requires --out with a frame pattern (frame_%%06d.png) or a .y4m path");
+
+    RecordingEncoder encoder = {
+        .cellSize    = CELL_SIZE,
+        .wallWidth   = WALL_WIDTH,
+        .frameEvents = args.steps > 1 ? args.steps : 0,
+        .threads     = 0,
+    };
+
+    if (!encoder.encode(args.encode, args.out))
+        DIE("could not encode %s to %s", args.encode, args.out);
+
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+
+    Args args = {
+        0, 0, 0, int(SolveStrat::FLOODFILL), -1, 0, 1, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0, 0, 0,
+        GEN_BACKTRACKER
+    };
 
     handle_start_args(args, argc, argv);
 
@@ -239,8 +626,44 @@ int main(int argc, char* argv[]) {
 
     srand(time(NULL));
 
-    World world;
-    Cell  cells[args.width * args.height];
+    if (args.trace) {
+
+        trace_enable();
+
+        trace_thread_name("main");
+    }
+
+    MazeView  loaded = {};
+    TiledMaze tiled  = {};
+
+    // a plain maze file, or failing that a tile archive
+    if (args.load) {
+
+        if (loaded.open(args.load)) {
+
+            args.width  = loaded.header->width;
+            args.height = loaded.header->height;
+
+        } else if (tiled.open(args.load, TILE_CACHE_TILES)) {
+
+            args.width  = tiled.header.width;
+            args.height = tiled.header.height;
+
+        } else {
+            DIE("could not load a maze from %s", args.load);
+        }
+    }
+
+    if (args.encode)
+        return run_encoder(args);
+
+    if (args.snapshot || args.save || args.text)
+        return run_headless(args, loaded, tiled);
+
+    uDetachFromTerminal();
+
+    World             world;
+    std::vector<Cell> cells((size_t)args.width * args.height);
 
     world.player = {
         .x = 0,
@@ -249,18 +672,42 @@ int main(int argc, char* argv[]) {
     };
 
     world.map = {
-        .cells = cells,
+        .cells = cells.data(),
         .percentLessWalls = args.percentLessWalls,
         .width = args.width,
         .height = args.height,
+        .generator = args.generator,
     };
 
     world.screenWidth  = 1024;
     world.screenHeight = 1024;
-    world.cellSize     = 25;
-    world.wallWidth    = 4;
+    world.cellSize     = CELL_SIZE;
+    world.wallWidth    = WALL_WIDTH;
+    world.renderMode   = RENDER_GRID;
+    world.fitCamera    = true;
+    world.followPlayer = false;
+    world.scrollDelta  = 0;
+    world.needsRedraw  = true;
+    world.keysDown     = 0;
+    world.swapInterval = args.vsync;
+    world.glDebug      = args.glDebug;
+
+    Recorder recorder;
 
-    world.map.buildRandomMaze();
+    if (args.record) {
+
+        if (!recorder.begin(args.record))
+            DIE("could not record to %s", args.record);
+
+        world.map.recorder = &recorder;
+    }
+
+    // a loaded maze is there right away, a generated one is shown while it's carved
+    bool generating = !args.load;
+
+    if (!generating) {
+        build_first_maze(args, loaded, tiled, world.map);
+    }
 
     bool reset   = false;
     bool autoRun = false;
@@ -270,39 +717,133 @@ int main(int argc, char* argv[]) {
 
     float solveSpeed = 0;
     float solveLastTime = 0;
-    bool       isSolved = false;
     SolveStrat strategy = SolveStrat(args.algo);
 
-    std::stack<glm::i32vec2> visitHistory;
-    std::queue<glm::i32vec2> floodnext;
+    bool threaded = args.threaded;
+
+    // inline mode steps the solver between frames with the players cooldown,
+    // threaded mode leaves it to a SimulationThread running at full speed
+    Simulation       sim = {.map = &world.map, .player = &world.player, .strategy = strategy};
+    SimulationThread simThread;
+
+    // resets swap in a maze built while this one was being solved
+    MazeBuilder builder;
+
+    sim.restart();
+
+    // --budget wins over --steps
+    StepBudget stepBudget = {
+        .steps       = args.budget > 0 ? 0 : args.steps,
+        .maxBudget   = args.budget * 1e-6,
+        .budget      = args.budget * 1e-6,
+        .targetFrame = TARGET_FRAME_TIME,
+        .spent       = 0,
+    };
+
+    bool solvedLastFrame = false;
+
+    double titleAt = TITLE_INTERVAL;
+    char   shownTitle[256] = "";
 
     world.initGLFW();
     world.initGL2D();
 
+    if (threaded) {
+        simThread.start(&world.map, strategy);
+    }
+
+    if (generating) {
+        builder.startLive(world.map, args.seeded ? args.seed : rand());
+    } else {
+        builder.start(world.map);
+    }
+
     while (!glfwWindowShouldClose(world.glwin)) {
 
-        world.beginFrame();
+        TRACE_ZONE("frame");
 
-        world.renderMap();
-        world.renderPlayer();
+        if (threaded) {
 
-        world.endFrame();
+            TRACE_ZONE("drain");
 
-        world.updateTime();
+            simThread.drain(world.map);
+
+            glm::i32vec2 pos = simThread.playerPosition();
+
+            world.player.x = pos.x;
+            world.player.y = pos.y;
+
+            reset = simThread.pathShown.load();
+        }
+
+        if (generating && builder.drainLive(world.map)) {
+
+            generating = false;
+
+            // the solvers saw nothing but walls so far
+            if (threaded) {
+
+                std::lock_guard<std::mutex> guard(simThread.lock);
+
+                simThread.restart(world.player.x, world.player.y);
 
-        // scale the map
-        if (world.screenWidth < world.screenHeight) {
-            if (world.map.width > world.map.height) {
-                world.cellSize = world.screenWidth / world.map.height;
             } else {
-                world.cellSize = world.screenWidth / world.map.width;
+                sim.restart();
+            }
+        }
+
+        bool redraw = world.frameChanged();
+
+        if (redraw) {
+
+            world.beginFrame();
+
+            world.renderMap();
+            world.renderPlayer();
+
+            world.endFrame();
+        }
+
+        // messages the driver logged since the last frame
+        if (world.glDebug) {
+            drainGlErrors();
+        }
+
+        bool solving = !generating && (autoRun || glfwGetKey(world.glwin, GLFW_KEY_SPACE));
+
+        // keep polling while something animates, otherwise sleep until input or the next solver step
+        double wait = 0;
+
+        if (!redraw) {
+
+            // the solver thread wakes us itself when it publishes colors
+            if ((solving && !threaded) || world.keysDown > 0) {
+                wait = std::max(world.player.movecooldown - world.player.lastmoved, 0.0f);
+            } else {
+                wait = IDLE_WAIT;
+            }
+
+            if (autoRun && reset) {
+                wait = std::min(wait, (double)std::max(resetAfter - resetAt, 0.0f));
             }
-        } else if (world.map.width > world.map.height) {
-            world.cellSize = world.screenHeight / world.map.height;
-        } else {
-            world.cellSize = world.screenHeight / world.map.width;
         }
 
+        {
+            TRACE_ZONE("waitEvents");
+
+            world.waitEvents(wait);
+        }
+
+        world.updateTime();
+
+        if (solvedLastFrame) {
+            stepBudget.adapt(world.deltaTime);
+        }
+
+        solvedLastFrame = false;
+
+        world.updateCamera();
+
         world.player.lastmoved += world.deltaTime;
         solveLastTime += world.deltaTime;
         resetAt += world.deltaTime;
@@ -310,7 +851,22 @@ int main(int argc, char* argv[]) {
         // player input
         if (world.player.lastmoved > world.player.movecooldown) {
 
-            do_player_move(world.glwin, world.map, world.player);
+            TRACE_ZONE("input");
+
+            if (threaded) {
+
+                std::lock_guard<std::mutex> guard(simThread.lock);
+
+                world.player.x = simThread.player.x;
+                world.player.y = simThread.player.y;
+
+                do_player_move(world.glwin, world.map, world.player);
+
+                simThread.setPlayerPosition(world.player.x, world.player.y);
+
+            } else {
+                do_player_move(world.glwin, world.map, world.player);
+            }
 
             if (glfwGetKey(world.glwin, GLFW_KEY_A)) {
 
@@ -319,78 +875,162 @@ int main(int argc, char* argv[]) {
                 autoRun = !autoRun;
             }
 
+            if (glfwGetKey(world.glwin, GLFW_KEY_G)) {
+
+                world.player.lastmoved = 0;
+
+                world.renderMode = world.renderMode == RENDER_GRID ? RENDER_QUADS : RENDER_GRID;
+            }
+
+            if (glfwGetKey(world.glwin, GLFW_KEY_F)) {
+
+                world.player.lastmoved = 0;
+
+                world.followPlayer = !world.followPlayer;
+                world.fitCamera    = false;
+            }
+
+            if (glfwGetKey(world.glwin, GLFW_KEY_C)) {
+
+                world.player.lastmoved = 0;
+
+                world.fitCamera    = true;
+                world.followPlayer = false;
+            }
+
             if(glfwGetKey(world.glwin, GLFW_KEY_I)) {
 
-                std::cout << "==============================" << std::endl;
+                // distances are written by the solver
+                std::unique_lock<std::mutex> guard(simThread.lock, std::defer_lock);
 
-                for (int y = 0; y < world.map.height; y++) {
+                if (threaded)
+                    guard.lock();
 
-                    for (int x = 0; x < world.map.width; x++) {
+                const char separator[] = "==============================\n";
 
-                        std::cout << pad_left(std::to_string(world.map.at(x, y)->distance), 4) << " ";
+                write(STDOUT_FILENO, separator, sizeof(separator) - 1);
 
-                    }
+                export_text(STDOUT_FILENO, world.map, TEXT_DISTANCES);
+            }
 
-                    std::cout << std::endl;
-                }
+            if (glfwGetKey(world.glwin, GLFW_KEY_P) && args.trace) {
+
+                world.player.lastmoved = 0;
+
+                if (!trace_dump(args.trace))
+                    fprintf(stderr, "could not write trace to %s\n", args.trace);
             }
         }
 
-        // auto solving
-        if (solveLastTime > solveSpeed) {
+        if (threaded) {
+
+            simThread.setRunning(solving);
 
+        } else if (solveLastTime > solveSpeed) {
+
+            // auto solving
             solveLastTime = 0;
 
-            if (autoRun || glfwGetKey(world.glwin, GLFW_KEY_SPACE)) {
+            if (solving) {
 
-                switch (strategy) {
+                stepBudget.run(sim);
 
-                case DFS:
+                solvedLastFrame = true;
 
-                    if (isSolved) {
-                        reset = dfs_show_path(world.map, world.player, visitHistory);
-                    } else {
-                        dfs_solve_maze(world.map, world.player, visitHistory, isSolved);
-                    }
+                reset = sim.pathShown;
+            }
+        }
 
-                    break;
+        titleAt += world.deltaTime;
 
-                case FLOODFILL:
+        if (titleAt >= TITLE_INTERVAL) {
 
-                    if (isSolved) {
-                        reset = floodfill_show_path(world.map, world.player);
-                    } else {
-                        floodfill_solve_maze(world.map, world.player, floodnext, isSolved);
-                    }
+            titleAt = 0;
 
-                    break;
-                }
+            SolverStats stats = sim.stats;
+
+            if (threaded) {
+
+                std::lock_guard<std::mutex> guard(simThread.lock);
+
+                stats = simThread.sim.stats;
+            }
+
+            char title[256];
+            int  length = snprintf(title, sizeof(title), "maze %dx%d - ", world.map.width, world.map.height);
+
+            stats.format(title + length, sizeof(title) - length, strategy);
+
+            GpuTimer& gpu = world.gpuTimer;
+
+            if (gpu.passTime[GPU_PASS_FLUSH] > 0) {
+
+                length = strlen(title);
+
+                snprintf(
+                    title + length, sizeof(title) - length, " | gpu flush %.2f ms", gpu.passTime[GPU_PASS_FLUSH] * 1e3
+                );
             }
 
-            if (!reset) {
-                resetAt = 0;
+            // only while the grid shader is what draws the maze
+            if (gpu.passTime[GPU_PASS_GRID] > 0) {
+
+                length = strlen(title);
+
+                snprintf(title + length, sizeof(title) - length, ", grid %.2f ms", gpu.passTime[GPU_PASS_GRID] * 1e3);
+            }
+
+            if (strcmp(title, shownTitle) != 0) {
+
+                glfwSetWindowTitle(world.glwin, title);
+
+                strcpy(shownTitle, title);
             }
         }
 
+        if (!reset) {
+            resetAt = 0;
+        }
+
         // map reset
-        if ((resetAt > resetAfter) && autoRun && reset || glfwGetKey(world.glwin, GLFW_KEY_R)) {
+        if (!generating && ((resetAt > resetAfter) && autoRun && reset || glfwGetKey(world.glwin, GLFW_KEY_R))) {
 
-            reset    = false;
-            isSolved = false;
+            reset = false;
 
             world.player.x = rand() % world.map.width;
             world.player.y = rand() % world.map.height;
 
-            world.map.buildRandomMaze();
+            if (threaded) {
+
+                std::lock_guard<std::mutex> guard(simThread.lock);
 
-            while (!visitHistory.empty())
-                visitHistory.pop();
+                builder.swapInto(world.map);
 
-            while (!floodnext.empty())
-                floodnext.pop();
+                simThread.restart(world.player.x, world.player.y);
+
+            } else {
+
+                builder.swapInto(world.map);
+
+                sim.restart();
+            }
         }
     }
 
+    if (threaded) {
+        simThread.stop();
+    }
+
+    builder.stop();
+
+    if (args.record) {
+        recorder.end();
+    }
+
+    if (args.trace) {
+        trace_dump(args.trace);
+    }
+
     glfwDestroyWindow(world.glwin);
 
     glfwTerminate();
@@ -0,0 +1,157 @@
+
+#include <algorithm>
+#include <cstdlib>
+#include "mazeBuilder.hpp"
+#include "trace.hpp"
+
+// the first maze stops showing up live past this many carved cells, and is shown once it's done
+constexpr size_t BUILDER_QUEUE_SIZE = 1 << 20;
+
+static void builder_main(MazeBuilder* b) {
+
+    trace_thread_name("builder");
+
+    std::unique_lock<std::mutex> guard(b->lock);
+
+    while (!b->quit) {
+
+        if (!b->building) {
+
+            b->wake.wait(guard);
+
+            continue;
+        }
+
+        b->next.generate(b->nextSeed);
+
+        if (b->carving.load(std::memory_order_relaxed)) {
+
+            b->next.carves = nullptr;
+
+            // everything in the queue was pushed before this
+            b->carving.store(false, std::memory_order_release);
+
+            glfwPostEmptyEvent();
+        }
+
+        b->building = false;
+
+        b->wake.notify_all();
+    }
+}
+
+void MazeBuilder::start(Map& like) {
+
+    this->cells.resize(like.length());
+
+    this->next = {
+        .cells            = this->cells.data(),
+        .percentLessWalls = like.percentLessWalls,
+        .width            = like.width,
+        .height           = like.height,
+        .generator        = like.generator,
+    };
+
+    // seeds still come from rand on the main thread, like buildRandomMaze
+    this->nextSeed = rand();
+    this->building = true;
+    this->quit     = false;
+
+    this->carving.store(false, std::memory_order_relaxed);
+
+    this->thread = std::thread(builder_main, this);
+}
+
+void MazeBuilder::startLive(Map& map, unsigned seed) {
+
+    this->cells.resize(map.length());
+
+    this->next = {
+        .cells            = this->cells.data(),
+        .percentLessWalls = map.percentLessWalls,
+        .width            = map.width,
+        .height           = map.height,
+        .generator        = map.generator,
+    };
+
+    // both cells of every passage or wall, a bit more with braiding or division's open grid
+    this->carves.create(std::min(map.length() * 4, BUILDER_QUEUE_SIZE));
+
+    this->next.carves = &this->carves;
+
+    // a blank grid for the walls to be carved out of
+    for (size_t i = 0; i < map.length(); i++) {
+        map.cells[i] = {.state = CELL_EMPTY, .walls = {1, 1, 1, 1}, .visited = false};
+    }
+
+    map.wallsVersion++;
+    map.markAllDirty();
+
+    this->nextSeed = seed;
+    this->building = true;
+    this->quit     = false;
+
+    this->carving.store(true, std::memory_order_relaxed);
+
+    this->thread = std::thread(builder_main, this);
+}
+
+bool MazeBuilder::drainLive(Map& map) {
+
+    TRACE_ZONE("drainCarves");
+
+    // the finished maze has every wall still in the queue, it's swapped in whole
+    if (!this->carving.load(std::memory_order_acquire)) {
+
+        this->swapInto(map);
+
+        return true;
+    }
+
+    WallChange change;
+
+    // cell by cell, so the wall mesh only redoes the lines carved through
+    while (this->carves.pop(change)) {
+
+        Cell* cell = map.cells + change.index;
+
+        for (int d = 0; d < 4; d++) {
+            cell->walls[d] = change.walls >> d & 1;
+        }
+
+        map.markDirty(change.index % map.width, change.index / map.width);
+
+        map.wallChanges.push_back(change.index);
+    }
+
+    return false;
+}
+
+void MazeBuilder::stop() {
+
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+
+        this->quit = true;
+    }
+
+    this->wake.notify_all();
+
+    this->thread.join();
+}
+
+void MazeBuilder::swapInto(Map& map) {
+
+    TRACE_ZONE("swapMaze");
+
+    std::unique_lock<std::mutex> guard(this->lock);
+
+    this->wake.wait(guard, [this]() { return !this->building; });
+
+    map.swapMaze(this->next);
+
+    this->nextSeed = rand();
+    this->building = true;
+
+    this->wake.notify_all();
+}
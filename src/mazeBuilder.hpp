@@ -0,0 +1,50 @@
+
+#ifndef MAZE_BUILDER_H
+#define MAZE_BUILDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "world.hpp"
+
+// Builds the next maze on its own thread while the current one is being solved, so a reset
+// trades cell buffers with it instead of stalling a frame on generation.
+// Holds lock while carving, next is only safe to touch with it held.
+struct MazeBuilder {
+
+        Map               next;
+        std::vector<Cell> cells; // the spare buffer, it and the map's own trade places on every swap
+
+        std::thread             thread;
+        std::mutex              lock;
+        std::condition_variable wake;
+
+        unsigned nextSeed;
+        bool     building; // nextSeed is waiting to be carved into next
+        bool     quit;
+
+        // walls of the first maze as it's carved, only for startLive
+        SpscQueue<WallChange> carves;
+        std::atomic<bool>     carving;
+
+        // builds mazes the size and braid of like, the first one right away
+        void start(Map& like);
+        void stop();
+
+        // like start, but the first maze is seed and map shows it being carved,
+        // drainLive has to be called every frame until it returns true
+        void startLive(Map& map, unsigned seed);
+
+        // copies what was carved since the last call into map,
+        // once the maze is done it's swapped in whole and the next one started
+        bool drainLive(Map& map);
+
+        // puts the next maze into map and starts on the one after,
+        // only waits when resets come faster than mazes get built
+        void swapInto(Map& map);
+};
+
+#endif
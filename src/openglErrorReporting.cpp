@@ -1,5 +1,30 @@
 #include "openglErrorReporting.h"
-#include <iostream>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+// messages waiting to be printed, more than this between drains are counted and dropped
+constexpr size_t GL_LOG_MESSAGES = 64;
+
+constexpr size_t GL_LOG_MESSAGE_LENGTH = 256;
+
+struct GlLogEntry {
+
+        GLenum       source;
+        GLenum       type;
+        GLenum       severity;
+        unsigned int id;
+        char         message[GL_LOG_MESSAGE_LENGTH];
+};
+
+// the driver may call back from its own threads when output isn't synchronous
+static std::mutex          logLock;
+static GlLogEntry          logEntries[GL_LOG_MESSAGES];
+static size_t              logWritten;
+static size_t              logRead;
+static size_t              logDropped;
+static std::atomic<size_t> logPending; // queued plus dropped, drained as soon as either is set
 
 //https://learnopengl.com/In-Practice/Debugging
 void GLAPIENTRY glDebugOutput(
@@ -17,83 +42,154 @@ void GLAPIENTRY glDebugOutput(
     if (type == GL_DEBUG_TYPE_PERFORMANCE)
         return;
 
-    std::cout << "---------------" << std::endl;
-    std::cout << "Debug message (" << id << "): " << message << std::endl;
+    std::lock_guard<std::mutex> guard(logLock);
+
+    if (logWritten - logRead >= GL_LOG_MESSAGES) {
+
+        logDropped++;
+
+        logPending.store(logWritten - logRead + logDropped, std::memory_order_release);
+
+        return;
+    }
+
+    GlLogEntry& entry = logEntries[logWritten % GL_LOG_MESSAGES];
+
+    entry.source   = source;
+    entry.type     = type;
+    entry.severity = severity;
+    entry.id       = id;
+
+    size_t count = length >= 0 ? (size_t)length : strlen(message);
+
+    count = count < GL_LOG_MESSAGE_LENGTH - 1 ? count : GL_LOG_MESSAGE_LENGTH - 1;
+
+    memcpy(entry.message, message, count);
+
+    entry.message[count] = 0;
+
+    logWritten++;
+
+    logPending.store(logWritten - logRead + logDropped, std::memory_order_release);
+}
+
+static const char* source_name(GLenum source) {
 
     switch (source) {
     case GL_DEBUG_SOURCE_API:
-        std::cout << "Source: API";
-        break;
+        return "API";
     case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
-        std::cout << "Source: Window System";
-        break;
+        return "Window System";
     case GL_DEBUG_SOURCE_SHADER_COMPILER:
-        std::cout << "Source: Shader Compiler";
-        break;
+        return "Shader Compiler";
     case GL_DEBUG_SOURCE_THIRD_PARTY:
-        std::cout << "Source: Third Party";
-        break;
+        return "Third Party";
     case GL_DEBUG_SOURCE_APPLICATION:
-        std::cout << "Source: Application";
-        break;
-    case GL_DEBUG_SOURCE_OTHER:
-        std::cout << "Source: Other";
-        break;
+        return "Application";
     }
-    std::cout << std::endl;
+
+    return "Other";
+}
+
+static const char* type_name(GLenum type) {
 
     switch (type) {
     case GL_DEBUG_TYPE_ERROR:
-        std::cout << "Type: Error";
-        break;
+        return "Error";
     case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
-        std::cout << "Type: Deprecated Behaviour";
-        break;
+        return "Deprecated Behaviour";
     case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
-        std::cout << "Type: Undefined Behaviour";
-        break;
+        return "Undefined Behaviour";
     case GL_DEBUG_TYPE_PORTABILITY:
-        std::cout << "Type: Portability";
-        break;
+        return "Portability";
     case GL_DEBUG_TYPE_PERFORMANCE:
-        std::cout << "Type: Performance";
-        break;
+        return "Performance";
     case GL_DEBUG_TYPE_MARKER:
-        std::cout << "Type: Marker";
-        break;
+        return "Marker";
     case GL_DEBUG_TYPE_PUSH_GROUP:
-        std::cout << "Type: Push Group";
-        break;
+        return "Push Group";
     case GL_DEBUG_TYPE_POP_GROUP:
-        std::cout << "Type: Pop Group";
-        break;
-    case GL_DEBUG_TYPE_OTHER:
-        std::cout << "Type: Other";
-        break;
+        return "Pop Group";
     }
-    std::cout << std::endl;
+
+    return "Other";
+}
+
+static const char* severity_name(GLenum severity) {
 
     switch (severity) {
     case GL_DEBUG_SEVERITY_HIGH:
-        std::cout << "Severity: high";
-        break;
+        return "high";
     case GL_DEBUG_SEVERITY_MEDIUM:
-        std::cout << "Severity: medium";
-        break;
+        return "medium";
     case GL_DEBUG_SEVERITY_LOW:
-        std::cout << "Severity: low";
-        break;
-    case GL_DEBUG_SEVERITY_NOTIFICATION:
-        std::cout << "Severity: notification";
-        break;
+        return "low";
     }
-    std::cout << std::endl;
-    std::cout << std::endl;
+
+    return "notification";
 }
 
-void enableReportGlErrors() {
+void drainGlErrors() {
+
+    if (logPending.load(std::memory_order_acquire) == 0)
+        return;
+
+    // copy out under the lock, print without it
+    GlLogEntry entries[GL_LOG_MESSAGES];
+    size_t     count;
+    size_t     dropped;
+
+    {
+        std::lock_guard<std::mutex> guard(logLock);
+
+        count = logWritten - logRead;
+
+        for (size_t i = 0; i < count; i++) {
+            entries[i] = logEntries[(logRead + i) % GL_LOG_MESSAGES];
+        }
+
+        dropped = logDropped;
+
+        logRead    = logWritten;
+        logDropped = 0;
+
+        logPending.store(0, std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+
+        GlLogEntry& entry = entries[i];
+
+        printf(
+            "---------------\n"
+            "Debug message (%u): %s\n"
+            "Source: %s\n"
+            "Type: %s\n"
+            "Severity: %s\n\n",
+            entry.id,
+            entry.message,
+            source_name(entry.source),
+            type_name(entry.type),
+            severity_name(entry.severity)
+        );
+    }
+
+    if (dropped > 0) {
+        printf("---------------\n%zu debug messages dropped\n\n", dropped);
+    }
+
+    fflush(stdout);
+}
+
+bool enableReportGlErrors() {
+
+    if (!glDebugMessageCallback)
+        return false;
+
+    // asynchronous, the driver doesn't have to stop and wait for the callback on every call
     glEnable(GL_DEBUG_OUTPUT);
-    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
     glDebugMessageCallback(glDebugOutput, nullptr);
     glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+
+    return true;
 }
@@ -2,6 +2,7 @@
 #include <glad/glad.h>
 
 //https://learnopengl.com/In-Practice/Debugging
+//only copies the message into a ring buffer, drainGlErrors prints them later
 void GLAPIENTRY glDebugOutput(GLenum source,
 	GLenum type,
 	unsigned int id,
@@ -10,5 +11,8 @@ void GLAPIENTRY glDebugOutput(GLenum source,
 	const char* message,
 	const void* userParam);
 
-void enableReportGlErrors();
+//false when the context has no debug output (it needs GL 4.3 or KHR_debug)
+bool enableReportGlErrors();
 
+//prints whatever the callback logged since the last call, cheap when there is nothing
+void drainGlErrors();
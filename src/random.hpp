@@ -0,0 +1,83 @@
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// The generator behind glibc's rand(), with its state kept here instead of in a global.
+// Seeded the same it returns the same numbers as srand and rand, so mazes built from a seed
+// don't change, but any number of threads can each run their own.
+struct Random {
+
+        uint32_t state[31];
+        int      front;
+        int      rear;
+
+        void seed(unsigned seed) {
+
+            if (seed == 0) {
+                seed = 1;
+            }
+
+            // a 32 bit int like glibc's, seeds past INT_MAX start out negative
+            int32_t word = (int32_t)seed;
+
+            this->state[0] = seed;
+
+            // state[i] = 16807 * state[i - 1] % 2147483647 without overflowing
+            for (int i = 1; i < 31; i++) {
+
+                int64_t hi = word / 127773;
+                int64_t lo = word % 127773;
+
+                word = (int32_t)(16807 * lo - 2836 * hi);
+
+                if (word < 0) {
+                    word += 2147483647;
+                }
+
+                this->state[i] = (uint32_t)word;
+            }
+
+            this->front = 3;
+            this->rear  = 0;
+
+            for (int i = 0; i < 310; i++) {
+                this->next();
+            }
+        }
+
+        // 0 to RAND_MAX
+        int next() {
+
+            uint32_t value = this->state[this->front] += this->state[this->rear];
+
+            this->front = this->front == 30 ? 0 : this->front + 1;
+            this->rear  = this->rear == 30 ? 0 : this->rear + 1;
+
+            return (int)(value >> 1);
+        }
+};
+
+// 64 random bits a call (splitmix64), for generators that want a coin flip per cell.
+// Seeding is free, so every row of a maze can get its own and be carved on any thread.
+struct RandomBits {
+
+        uint64_t state;
+
+        void seed(uint64_t seed) {
+            this->state = seed;
+        }
+
+        uint64_t next() {
+
+            uint64_t z = this->state += 0x9e3779b97f4a7c15;
+
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+
+            return z ^ (z >> 31);
+        }
+};
+
+#endif
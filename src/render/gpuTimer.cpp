@@ -0,0 +1,108 @@
+
+#include "gpuTimer.hpp"
+
+// seconds, anything longer is a broken result rather than a slow pass
+constexpr double GPU_TIMER_MAX_PASS = 1.0;
+
+void GpuTimer::create() {
+
+    glGenQueries(GPU_PASS_COUNT * GPU_TIMER_FRAMES, &this->queries[0][0]);
+
+    for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+
+        for (int i = 0; i < GPU_TIMER_FRAMES; i++) {
+            this->pending[pass][i] = false;
+        }
+
+        this->passTime[pass]  = 0;
+        this->lastBegun[pass] = -1;
+    }
+
+    this->created = true;
+    this->frame   = 0;
+    this->active  = -1;
+}
+
+void GpuTimer::cleanup() {
+
+    if (this->created) {
+        glDeleteQueries(GPU_PASS_COUNT * GPU_TIMER_FRAMES, &this->queries[0][0]);
+    }
+
+    this->created = false;
+}
+
+void GpuTimer::begin(GpuPass pass) {
+
+    int slot = this->frame % GPU_TIMER_FRAMES;
+
+    if (!this->created || this->active >= 0 || this->pending[pass][slot]) {
+        return;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, this->queries[pass][slot]);
+
+    this->active          = pass;
+    this->lastBegun[pass] = this->frame;
+}
+
+void GpuTimer::end() {
+
+    if (this->active < 0) {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED);
+
+    this->pending[this->active][this->frame % GPU_TIMER_FRAMES] = true;
+
+    this->active = -1;
+}
+
+void GpuTimer::endFrame() {
+
+    if (!this->created) {
+        return;
+    }
+
+    for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+
+        for (int i = 0; i < GPU_TIMER_FRAMES; i++) {
+
+            if (!this->pending[pass][i]) {
+                continue;
+            }
+
+            GLint available = 0;
+
+            glGetQueryObjectiv(this->queries[pass][i], GL_QUERY_RESULT_AVAILABLE, &available);
+
+            if (!available) {
+                continue;
+            }
+
+            GLuint64 elapsed = 0;
+
+            glGetQueryObjectui64v(this->queries[pass][i], GL_QUERY_RESULT, &elapsed);
+
+            this->pending[pass][i] = false;
+
+            double seconds = elapsed * 1e-9;
+
+            // some drivers hand back garbage for the first query they ever run
+            if (seconds > GPU_TIMER_MAX_PASS) {
+                continue;
+            }
+
+            // smoothed like the solver budget, starting from the first result
+            this->passTime[pass] = this->passTime[pass] ? this->passTime[pass] * 0.8 + seconds * 0.2 : seconds;
+        }
+
+        // every query it had in flight has come back by now
+        if (this->frame - this->lastBegun[pass] > GPU_TIMER_FRAMES) {
+            this->passTime[pass] = 0;
+        }
+    }
+
+    this->frame++;
+}
@@ -0,0 +1,34 @@
+
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include "gl2d/gl2d.h"
+
+typedef enum { GPU_PASS_GRID, GPU_PASS_FLUSH, GPU_PASS_COUNT } GpuPass;
+
+// frames of queries in flight, results are read this many frames late so nothing waits on the gpu
+constexpr int GPU_TIMER_FRAMES = 4;
+
+// GL_TIME_ELAPSED queries around each pass of a frame.
+// Every pass gets a query per frame in flight, a slot whose result hasn't come back yet is
+// skipped for that frame rather than waited on. A pass that stops running drops back to zero
+// once its last results are in. Does nothing until created.
+struct GpuTimer {
+
+        GLuint queries[GPU_PASS_COUNT][GPU_TIMER_FRAMES];
+        bool   pending[GPU_PASS_COUNT][GPU_TIMER_FRAMES];
+        bool   created;
+        int    frame;
+        int    active; // pass being timed, -1 if none
+        int    lastBegun[GPU_PASS_COUNT]; // frame each pass last ran in
+
+        double passTime[GPU_PASS_COUNT]; // seconds, smoothed over frames
+
+        void create();
+        void cleanup();
+        void begin(GpuPass pass);
+        void end();
+        void endFrame(); // collects finished results, call once per frame after the last pass
+};
+
+#endif
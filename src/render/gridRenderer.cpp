@@ -0,0 +1,220 @@
+
+#include <algorithm>
+#include "gridRenderer.hpp"
+#include "../world.hpp"
+
+static const char* gridVertexShader = GL2D_OPNEGL_SHADER_VERSION "\n"
+                                      "void main()\n"
+                                      "{\n"
+                                      "    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+                                      "    gl_Position = vec4(corner * 2.0 - 1.0, 0, 1);\n"
+                                      "}\n";
+
+static const char* gridFragmentShader = GL2D_OPNEGL_SHADER_VERSION "\n" GL2D_OPNEGL_SHADER_PRECISION "\n"
+                                        "out vec4 color;\n"
+                                        "uniform usampler2D u_sampler;\n"
+                                        "uniform vec2  u_screen;\n"
+                                        "uniform vec2  u_camera;\n"
+                                        "uniform float u_zoom;\n"
+                                        "uniform float u_cellSize;\n"
+                                        "uniform float u_wallWidth;\n"
+                                        "uniform ivec2 u_mapSize;\n"
+                                        "uniform vec4  u_wallColor;\n"
+                                        "uniform vec4  u_palette[16];\n"
+                                        "void main()\n"
+                                        "{\n"
+                                        "    vec2 screen = vec2(gl_FragCoord.x, u_screen.y - gl_FragCoord.y);\n"
+                                        "    vec2 world  = (screen - u_screen * 0.5) / u_zoom + u_screen * 0.5 + u_camera;\n"
+                                        "    ivec2 cell  = ivec2(floor(world / u_cellSize));\n"
+                                        "    if (any(lessThan(cell, ivec2(0))) || any(greaterThanEqual(cell, u_mapSize)))\n"
+                                        "        discard;\n"
+                                        "    uint  texel = texelFetch(u_sampler, cell, 0).r;\n"
+                                        "    vec2  local = world - vec2(cell) * u_cellSize;\n"
+                                        "    float far   = u_cellSize - u_wallWidth;\n"
+                                        "    bool  wall  = ((texel & 1u) != 0u && local.y < u_wallWidth)\n"
+                                        "               || ((texel & 2u) != 0u && local.y >= far)\n"
+                                        "               || ((texel & 4u) != 0u && local.x >= far)\n"
+                                        "               || ((texel & 8u) != 0u && local.x < u_wallWidth);\n"
+                                        "    color = wall ? u_wallColor : u_palette[texel >> 4];\n"
+                                        "}\n";
+
+// the state goes in the high nibble, u_palette has room for 16
+static_assert(CELL_STATE_COUNT <= 16, "cell states must fit in 4 bits");
+
+static uint8_t pack_cell(Cell* cell) {
+
+    uint8_t walls = 0;
+
+    for (int d = 0; d < 4; d++) {
+
+        if (cell->walls[d]) {
+            walls |= 1 << d;
+        }
+    }
+
+    return walls | cell->state << 4;
+}
+
+void GridRenderer::create() {
+
+    gl2d::ShaderProgram shader = gl2d::createShaderProgram(gridVertexShader, gridFragmentShader);
+
+    this->program = shader.id;
+
+    this->uScreen    = glGetUniformLocation(this->program, "u_screen");
+    this->uCamera    = glGetUniformLocation(this->program, "u_camera");
+    this->uZoom      = glGetUniformLocation(this->program, "u_zoom");
+    this->uCellSize  = glGetUniformLocation(this->program, "u_cellSize");
+    this->uWallWidth = glGetUniformLocation(this->program, "u_wallWidth");
+    this->uMapSize   = glGetUniformLocation(this->program, "u_mapSize");
+    this->uWallColor = glGetUniformLocation(this->program, "u_wallColor");
+    this->uPalette   = glGetUniformLocation(this->program, "u_palette");
+
+    glUseProgram(this->program);
+    glUniform1i(shader.u_sampler, 0);
+    glUseProgram(0);
+
+    // core profile won't draw without a vao, the quad itself comes from gl_VertexID
+    glGenVertexArrays(1, &this->vao);
+
+    glGenTextures(1, &this->cellTexture);
+
+    this->texWidth  = 0;
+    this->texHeight = 0;
+
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &this->maxTextureSize);
+}
+
+void GridRenderer::cleanup() {
+
+    glDeleteTextures(1, &this->cellTexture);
+    glDeleteVertexArrays(1, &this->vao);
+    glDeleteProgram(this->program);
+
+    this->staging.clear();
+    this->staging.shrink_to_fit();
+}
+
+bool GridRenderer::supports(Map& map) {
+    return this->program && map.width <= this->maxTextureSize && map.height <= this->maxTextureSize;
+}
+
+void GridRenderer::invalidate() {
+
+    this->texWidth  = 0;
+    this->texHeight = 0;
+}
+
+void GridRenderer::upload(Map& map) {
+
+    bool resized = this->texWidth != map.width || this->texHeight != map.height;
+
+    if (!resized && !map.allDirty && map.dirtyCells.empty()) {
+        return;
+    }
+
+    size_t len = map.length();
+
+    this->staging.resize(len);
+
+    uint8_t* mirror = this->staging.data();
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, this->cellTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (resized || map.allDirty) {
+
+        for (size_t i = 0; i < len; i++) {
+            mirror[i] = pack_cell(map.cells + i);
+        }
+
+        if (resized) {
+
+            this->texWidth  = map.width;
+            this->texHeight = map.height;
+
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+            glTexImage2D(
+                GL_TEXTURE_2D, 0, GL_R8UI, map.width, map.height, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, mirror
+            );
+
+        } else {
+
+            glTexSubImage2D(
+                GL_TEXTURE_2D, 0, 0, 0, map.width, map.height, GL_RED_INTEGER, GL_UNSIGNED_BYTE, mirror
+            );
+        }
+
+        return;
+    }
+
+    std::vector<int>& dirty = map.dirtyCells;
+
+    std::sort(dirty.begin(), dirty.end());
+
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, map.width);
+
+    // upload runs of neighbouring dirty cells on the same row as one span
+    for (size_t i = 0; i < dirty.size();) {
+
+        int first = dirty[i];
+        int last  = first;
+        int row   = first / map.width;
+
+        mirror[first] = pack_cell(map.cells + first);
+
+        for (i++; i < dirty.size() && dirty[i] == last + 1 && dirty[i] / map.width == row; i++) {
+
+            last = dirty[i];
+
+            mirror[last] = pack_cell(map.cells + last);
+        }
+
+        glTexSubImage2D(
+            GL_TEXTURE_2D,
+            0,
+            first % map.width,
+            row,
+            last - first + 1,
+            1,
+            GL_RED_INTEGER,
+            GL_UNSIGNED_BYTE,
+            mirror + first
+        );
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+void GridRenderer::render(
+    Map& map, gl2d::Camera& camera, int screenWidth, int screenHeight, int cellSize, int wallWidth
+) {
+
+    gl2d::Color4f wallColor = ColorWall;
+
+    glUseProgram(this->program);
+
+    glUniform2f(this->uScreen, (float)screenWidth, (float)screenHeight);
+    glUniform2f(this->uCamera, camera.position.x, camera.position.y);
+    glUniform1f(this->uZoom, camera.zoom);
+    glUniform1f(this->uCellSize, (float)cellSize);
+    glUniform1f(this->uWallWidth, (float)wallWidth);
+    glUniform2i(this->uMapSize, map.width, map.height);
+    glUniform4f(this->uWallColor, wallColor.r, wallColor.g, wallColor.b, wallColor.a);
+    glUniform4fv(this->uPalette, CELL_STATE_COUNT, &cellPalette[0].r);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, this->cellTexture);
+
+    glBindVertexArray(this->vao);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glBindVertexArray(0);
+
+    glUseProgram(0);
+}
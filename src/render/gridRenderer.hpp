@@ -0,0 +1,47 @@
+
+#ifndef GRID_RENDERER_H
+#define GRID_RENDERER_H
+
+#include <cstdint>
+#include <vector>
+#include "gl2d/gl2d.h"
+
+struct Map;
+
+// Draws the whole maze as a single screen covering quad.
+// Every cell is one byte of an integer texture (low nibble = wall bits, high = CellState)
+// and the fragment shader works out which cell and which wall a pixel lands on, then looks the
+// cell up in cellPalette, so the cost of a frame does not depend on the size of the map.
+// The texture lives across frames, only the cells in Map::dirtyCells get re-uploaded
+// and a renderer that sat out a frame with changes is invalidated and rebuilt on next use.
+struct GridRenderer {
+
+        GLuint program;
+        GLuint vao;
+        GLuint cellTexture;
+
+        GLint uScreen;
+        GLint uCamera;
+        GLint uZoom;
+        GLint uCellSize;
+        GLint uWallWidth;
+        GLint uMapSize;
+        GLint uWallColor;
+        GLint uPalette;
+
+        int texWidth;
+        int texHeight;
+        int maxTextureSize;
+
+        // cpu copy of the texture, dirty spans are uploaded straight out of it
+        std::vector<uint8_t> staging;
+
+        void create();
+        void cleanup();
+        bool supports(Map& map);
+        void invalidate();
+        void upload(Map& map);
+        void render(Map& map, gl2d::Camera& camera, int screenWidth, int screenHeight, int cellSize, int wallWidth);
+};
+
+#endif
@@ -0,0 +1,216 @@
+
+#include <algorithm>
+#include "overviewRenderer.hpp"
+#include "../world.hpp"
+
+// the color a whole cell averages out to, walls included
+static void shade_cell(uint8_t* out, Cell* cell, int cellSize, int wallWidth) {
+
+    float inner = (float)std::max(cellSize - wallWidth * (cell->walls[WEST] + cell->walls[EAST]), 0);
+    float outer = (float)std::max(cellSize - wallWidth * (cell->walls[NORTH] + cell->walls[SOUTH]), 0);
+
+    float open = inner * outer / (float)(cellSize * cellSize);
+
+    gl2d::Color4f color = cellPalette[cell->state] * open + ColorWall * (1 - open);
+
+    out[0] = (uint8_t)(color.r * 255.0f);
+    out[1] = (uint8_t)(color.g * 255.0f);
+    out[2] = (uint8_t)(color.b * 255.0f);
+    out[3] = 255;
+}
+
+// averages the 2x2 texels under a parent, the last parent of a row or column also takes in the
+// odd texel past them so the right and bottom edges still show up in every level
+static void downsample_texel(
+    std::vector<uint8_t>& dst, glm::ivec2 dstSize, std::vector<uint8_t>& src, glm::ivec2 srcSize, int x, int y
+) {
+
+    int x0 = std::min(x * 2, srcSize.x - 1);
+    int y0 = std::min(y * 2, srcSize.y - 1);
+    int x1 = x == dstSize.x - 1 ? srcSize.x : x0 + 2;
+    int y1 = y == dstSize.y - 1 ? srcSize.y : y0 + 2;
+
+    int sum[4] = {};
+    int count  = (x1 - x0) * (y1 - y0);
+
+    for (int sy = y0; sy < y1; sy++) {
+
+        const uint8_t* texel = &src[((size_t)sy * srcSize.x + x0) * 4];
+
+        for (int sx = x0; sx < x1; sx++, texel += 4) {
+
+            for (int i = 0; i < 4; i++) {
+                sum[i] += texel[i];
+            }
+        }
+    }
+
+    uint8_t* out = &dst[((size_t)y * dstSize.x + x) * 4];
+
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)((sum[i] + count / 2) / count);
+    }
+}
+
+// uploads the given texels of one level, neighbours on a row go up as one span
+static void upload_texels(int level, glm::ivec2 size, std::vector<uint8_t>& data, std::vector<int>& texels) {
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, size.x);
+
+    for (size_t i = 0; i < texels.size();) {
+
+        int first = texels[i];
+        int last  = first;
+        int row   = first / size.x;
+
+        for (i++; i < texels.size() && texels[i] == last + 1 && texels[i] / size.x == row; i++) {
+            last = texels[i];
+        }
+
+        glTexSubImage2D(
+            GL_TEXTURE_2D,
+            level,
+            first % size.x,
+            row,
+            last - first + 1,
+            1,
+            GL_RGBA,
+            GL_UNSIGNED_BYTE,
+            &data[(size_t)first * 4]
+        );
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+void OverviewRenderer::create() {
+
+    glGenTextures(1, &this->texture.id);
+
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &this->maxTextureSize);
+
+    this->stale = true;
+}
+
+void OverviewRenderer::cleanup() {
+
+    this->texture.cleanup();
+
+    this->levels.clear();
+    this->sizes.clear();
+}
+
+bool OverviewRenderer::supports(Map& map) {
+    return this->texture.id && map.width <= this->maxTextureSize && map.height <= this->maxTextureSize;
+}
+
+void OverviewRenderer::invalidate() {
+    this->stale = true;
+}
+
+void OverviewRenderer::upload(Map& map, int cellSize, int wallWidth) {
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, this->texture.id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (this->stale || map.allDirty || this->sizes.empty() || this->sizes[0] != glm::ivec2(map.width, map.height)) {
+
+        this->stale = false;
+
+        this->sizes.clear();
+        this->sizes.push_back({map.width, map.height});
+
+        while (this->sizes.back().x > 1 || this->sizes.back().y > 1) {
+
+            glm::ivec2 size = this->sizes.back();
+
+            this->sizes.push_back({std::max(size.x / 2, 1), std::max(size.y / 2, 1)});
+        }
+
+        this->levels.resize(this->sizes.size());
+
+        for (size_t l = 0; l < this->sizes.size(); l++) {
+
+            glm::ivec2 size = this->sizes[l];
+
+            this->levels[l].resize((size_t)size.x * size.y * 4);
+
+            for (int y = 0; y < size.y; y++) {
+
+                for (int x = 0; x < size.x; x++) {
+
+                    if (l == 0) {
+                        shade_cell(&this->levels[0][((size_t)y * size.x + x) * 4], map.at(x, y), cellSize, wallWidth);
+                    } else {
+                        downsample_texel(this->levels[l], size, this->levels[l - 1], this->sizes[l - 1], x, y);
+                    }
+                }
+            }
+
+            glTexImage2D(
+                GL_TEXTURE_2D, l, GL_RGBA8, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, this->levels[l].data()
+            );
+        }
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)this->sizes.size() - 1);
+
+        return;
+    }
+
+    if (map.dirtyCells.empty()) {
+        return;
+    }
+
+    std::vector<int> texels = map.dirtyCells;
+
+    for (size_t l = 0; l < this->sizes.size(); l++) {
+
+        glm::ivec2 size = this->sizes[l];
+
+        std::sort(texels.begin(), texels.end());
+
+        texels.erase(std::unique(texels.begin(), texels.end()), texels.end());
+
+        for (int i : texels) {
+
+            int x = i % size.x;
+            int y = i / size.x;
+
+            if (l == 0) {
+                shade_cell(&this->levels[0][(size_t)i * 4], map.cells + i, cellSize, wallWidth);
+            } else {
+                downsample_texel(this->levels[l], size, this->levels[l - 1], this->sizes[l - 1], x, y);
+            }
+        }
+
+        upload_texels(l, size, this->levels[l], texels);
+
+        if (l + 1 == this->sizes.size()) {
+            break;
+        }
+
+        // move every texel to its parent, the odd last row or column of a level folds into the one before it
+        glm::ivec2 parent = this->sizes[l + 1];
+
+        for (int& i : texels) {
+
+            int x = std::min(i % size.x / 2, parent.x - 1);
+            int y = std::min(i / size.x / 2, parent.y - 1);
+
+            i = y * parent.x + x;
+        }
+    }
+}
+
+void OverviewRenderer::render(gl2d::Renderer2D& r2d, Map& map, int cellSize) {
+
+    gl2d::Rect rect = {0, 0, map.width * cellSize, map.height * cellSize};
+
+    // row 0 of the pyramid is the top of the map
+    r2d.renderRectangle(rect, this->texture, Colors_White, {}, 0, {0, 0, 1, 1});
+}
@@ -0,0 +1,33 @@
+
+#ifndef OVERVIEW_RENDERER_H
+#define OVERVIEW_RENDERER_H
+
+#include <cstdint>
+#include <vector>
+#include "gl2d/gl2d.h"
+
+struct Map;
+
+// Level of detail view for when cells get smaller than a pixel.
+// Keeps a mip pyramid of the maze on the cpu (one texel per cell at the base, each level
+// above averages 2x2 texels of the one below) and mirrors it into a mipmapped texture
+// that is drawn as a single gl2d quad. Changed cells only touch their own chain of texels.
+struct OverviewRenderer {
+
+        gl2d::Texture texture;
+
+        std::vector<std::vector<uint8_t>> levels;
+        std::vector<glm::ivec2>           sizes;
+
+        int  maxTextureSize;
+        bool stale;
+
+        void create();
+        void cleanup();
+        bool supports(Map& map);
+        void invalidate();
+        void upload(Map& map, int cellSize, int wallWidth);
+        void render(gl2d::Renderer2D& r2d, Map& map, int cellSize);
+};
+
+#endif
@@ -0,0 +1,180 @@
+
+#include <algorithm>
+#include "wallMesh.hpp"
+#include "../world.hpp"
+
+// walled sides of the line above row y, at column x
+static uint8_t row_sides(Map& map, int x, int y) {
+
+    uint8_t sides = 0;
+
+    if (y > 0 && map.cells[(y - 1) * map.width + x].walls[SOUTH]) {
+        sides |= WALL_BEFORE;
+    }
+
+    if (y < map.height && map.cells[y * map.width + x].walls[NORTH]) {
+        sides |= WALL_AFTER;
+    }
+
+    return sides;
+}
+
+// walled sides of the line left of column x, at row y
+static uint8_t column_sides(Map& map, int x, int y) {
+
+    uint8_t sides = 0;
+
+    if (x > 0 && map.cells[y * map.width + x - 1].walls[EAST]) {
+        sides |= WALL_BEFORE;
+    }
+
+    if (x < map.width && map.cells[y * map.width + x].walls[WEST]) {
+        sides |= WALL_AFTER;
+    }
+
+    return sides;
+}
+
+// splits one line into runs, cells are 0..length along it
+template <typename Sides>
+static void mesh_line(std::vector<WallRun>& runs, int length, Sides sides) {
+
+    int i = 0;
+
+    while (i < length) {
+
+        uint8_t kind  = sides(i);
+        int     start = i;
+
+        while (i < length && sides(i) == kind) {
+            i++;
+        }
+
+        if (kind) {
+            runs.push_back({.start = start, .end = i, .sides = kind});
+        }
+    }
+}
+
+// the first run of a line that reaches past from
+static const WallRun* first_visible(const std::vector<WallRun>& runs, int from) {
+    return std::lower_bound(runs.data(), runs.data() + runs.size(), from, [](const WallRun& run, int from) {
+        return run.end <= from;
+    });
+}
+
+static void mesh_row(std::vector<WallRun>& runs, Map& map, int y) {
+
+    runs.clear();
+
+    mesh_line(runs, map.width, [&](int x) { return row_sides(map, x, y); });
+}
+
+static void mesh_column(std::vector<WallRun>& runs, Map& map, int x) {
+
+    runs.clear();
+
+    mesh_line(runs, map.height, [&](int y) { return column_sides(map, x, y); });
+}
+
+void WallMesh::invalidate() {
+    this->cells = nullptr;
+}
+
+void WallMesh::build(Map& map) {
+
+    this->rows.resize(map.height + 1);
+    this->columns.resize(map.width + 1);
+
+    this->staleRows.assign(map.height + 1, 0);
+    this->staleColumns.assign(map.width + 1, 0);
+
+    for (int y = 0; y <= map.height; y++) {
+        mesh_row(this->rows[y], map, y);
+    }
+
+    for (int x = 0; x <= map.width; x++) {
+        mesh_column(this->columns[x], map, x);
+    }
+
+    this->cells   = map.cells;
+    this->version = map.wallsVersion;
+}
+
+void WallMesh::update(Map& map) {
+
+    // a mesh that's out of date is built again from scratch anyway
+    if (this->cells != map.cells || this->version != map.wallsVersion) {
+        return;
+    }
+
+    for (int i : map.wallChanges) {
+
+        int x = i % map.width;
+        int y = i / map.width;
+
+        // a cell's walls sit on the lines on both of its sides
+        this->staleRows[y]        = 1;
+        this->staleRows[y + 1]    = 1;
+        this->staleColumns[x]     = 1;
+        this->staleColumns[x + 1] = 1;
+    }
+}
+
+void WallMesh::render(gl2d::Renderer2D& r2d, Map& map, int x0, int y0, int x1, int y1, int cellSize, int wallWidth) {
+
+    if (this->cells != map.cells || this->version != map.wallsVersion) {
+        this->build(map);
+    }
+
+    // the line below the last visible row still belongs to it
+    for (int y = y0; y <= y1; y++) {
+
+        std::vector<WallRun>& runs = this->rows[y];
+
+        if (this->staleRows[y]) {
+
+            mesh_row(runs, map, y);
+
+            this->staleRows[y] = 0;
+        }
+
+        const WallRun* run = first_visible(runs, x0);
+        const WallRun* end = runs.data() + runs.size();
+
+        for (; run != end && run->start < x1; run++) {
+
+            int top    = y * cellSize - (run->sides & WALL_BEFORE ? wallWidth : 0);
+            int bottom = y * cellSize + (run->sides & WALL_AFTER ? wallWidth : 0);
+
+            r2d.renderSolidRectangle(
+                {run->start * cellSize, top, (run->end - run->start) * cellSize, bottom - top}, ColorWall
+            );
+        }
+    }
+
+    for (int x = x0; x <= x1; x++) {
+
+        std::vector<WallRun>& runs = this->columns[x];
+
+        if (this->staleColumns[x]) {
+
+            mesh_column(runs, map, x);
+
+            this->staleColumns[x] = 0;
+        }
+
+        const WallRun* run = first_visible(runs, y0);
+        const WallRun* end = runs.data() + runs.size();
+
+        for (; run != end && run->start < y1; run++) {
+
+            int left  = x * cellSize - (run->sides & WALL_BEFORE ? wallWidth : 0);
+            int right = x * cellSize + (run->sides & WALL_AFTER ? wallWidth : 0);
+
+            r2d.renderSolidRectangle(
+                {left, run->start * cellSize, right - left, (run->end - run->start) * cellSize}, ColorWall
+            );
+        }
+    }
+}
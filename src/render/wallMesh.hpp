@@ -0,0 +1,47 @@
+
+#ifndef WALL_MESH_H
+#define WALL_MESH_H
+
+#include <cstdint>
+#include <vector>
+#include "gl2d/gl2d.h"
+
+struct Cell;
+struct Map;
+
+// walls on one side of a line between two rows (or columns)
+typedef enum { WALL_BEFORE = 1, WALL_AFTER = 2 } WallSide;
+
+// cells [start, end) along one line that all have the same walls on it
+struct WallRun {
+
+        int     start;
+        int     end;
+        uint8_t sides; // WALL_BEFORE for the south/east walls of the cells above/left, WALL_AFTER for the other side
+};
+
+// Maze walls for the quad path, merged into as few rectangles as possible.
+// Every cell draws its own half of a shared wall, so the walls along each line between two rows
+// (and two columns) are grouped into runs of cells with the same sides walled, one rectangle each.
+// Built once per maze (Map::wallsVersion) and kept per line, sorted, so a frame only looks at the
+// runs crossing the view. Cells carved one at a time (Map::wallChanges) only mark their lines
+// stale, those are meshed again once they're in view.
+struct WallMesh {
+
+        // runs of line i, line i sits above row i (left of column i)
+        std::vector<std::vector<WallRun>> rows;
+        std::vector<std::vector<WallRun>> columns;
+        std::vector<uint8_t>              staleRows;
+        std::vector<uint8_t>              staleColumns;
+
+        // the maze the runs were built from
+        const Cell* cells;
+        unsigned    version;
+
+        void invalidate();
+        void build(Map& map);
+        void update(Map& map); // marks the lines of map.wallChanges stale
+        void render(gl2d::Renderer2D& r2d, Map& map, int x0, int y0, int x1, int y1, int cellSize, int wallWidth);
+};
+
+#endif
@@ -0,0 +1,288 @@
+
+#include <algorithm>
+#include <chrono>
+#include "simulation.hpp"
+#include "trace.hpp"
+
+// steps run back to back before the lock is handed back to the render thread
+constexpr int SIM_BATCH_STEPS = 256;
+
+// a step paints at most one cell, stop the batch before the queue can overflow
+constexpr size_t SIM_QUEUE_MARGIN = 4;
+
+constexpr size_t SIM_QUEUE_SIZE = 1 << 16;
+
+// steps between clock reads when solving against a time budget
+constexpr int BUDGET_CHECK_STEPS = 64;
+
+// a frame always gets some solving, even if rendering alone blows the target
+constexpr double BUDGET_MIN = 0.0005;
+
+static uint64_t pack_position(int x, int y) {
+    return (uint64_t)(uint32_t)x << 32 | (uint32_t)y;
+}
+
+void Simulation::step() {
+
+    switch (this->strategy) {
+
+    case DFS:
+
+        if (this->isSolved) {
+            this->pathShown = dfs_show_path(*this->map, *this->player, this->visitHistory, this->stats);
+        } else {
+            dfs_solve_maze(*this->map, *this->player, this->visitHistory, this->isSolved, this->stats);
+        }
+
+        break;
+
+    case FLOODFILL:
+
+        if (this->isSolved) {
+            this->pathShown = floodfill_show_path(*this->map, *this->player, this->stats);
+        } else {
+            floodfill_solve_maze(*this->map, *this->player, this->floodnext, this->isSolved, this->stats);
+        }
+
+        break;
+    }
+}
+
+// the clock is read once a call and once more when the search finishes, not per step
+int Simulation::run(int maxSteps) {
+
+    TRACE_ZONE("solve");
+
+    auto start = std::chrono::steady_clock::now();
+
+    bool searching = !this->isSolved;
+    int  taken     = 0;
+
+    for (; taken < maxSteps && !this->pathShown; taken++) {
+
+        this->step();
+
+        if (searching && this->isSolved) {
+
+            auto now = std::chrono::steady_clock::now();
+
+            this->stats.searchTime += std::chrono::duration<double>(now - start).count();
+
+            start     = now;
+            searching = false;
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (searching) {
+        this->stats.searchTime += elapsed;
+    } else {
+        this->stats.pathTime += elapsed;
+    }
+
+    this->stats.peakWorkspaceBytes = this->stats.maxFrontier * sizeof(glm::i32vec2);
+
+    return taken;
+}
+
+void Simulation::restart() {
+
+    this->isSolved  = false;
+    this->pathShown = false;
+    this->stats     = {};
+
+    while (!this->visitHistory.empty())
+        this->visitHistory.pop();
+
+    while (!this->floodnext.empty())
+        this->floodnext.pop();
+}
+
+int StepBudget::run(Simulation& sim) {
+
+    auto start = std::chrono::steady_clock::now();
+
+    int taken = 0;
+
+    if (this->steps > 0) {
+
+        taken = sim.run(this->steps);
+
+    } else {
+
+        auto end = start + std::chrono::duration<double>(this->budget);
+
+        while (!sim.pathShown) {
+
+            taken += sim.run(BUDGET_CHECK_STEPS);
+
+            if (std::chrono::steady_clock::now() >= end) {
+                break;
+            }
+        }
+    }
+
+    this->spent = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return taken;
+}
+
+// frameTime is the whole of the frame the last run was part of
+void StepBudget::adapt(double frameTime) {
+
+    if (this->steps > 0) {
+        return;
+    }
+
+    double room = this->targetFrame - (frameTime - this->spent);
+
+    // smooth it out, one slow frame shouldn't stall the solve
+    this->budget = std::clamp(this->budget * 0.8 + room * 0.2, std::min(BUDGET_MIN, this->maxBudget), this->maxBudget);
+}
+
+static void simulation_main(SimulationThread* t) {
+
+    trace_thread_name("solver");
+
+    std::unique_lock<std::mutex> guard(t->lock);
+
+    while (!t->quit.load()) {
+
+        // nothing to do until started, or restarted after the path is drawn
+        if (!t->running.load() || t->sim.pathShown) {
+
+            t->wake.wait(guard);
+
+            continue;
+        }
+
+        // the render thread is behind, give it a moment to drain
+        if (t->changes.space() < SIM_QUEUE_MARGIN) {
+
+            t->wake.wait_for(guard, std::chrono::milliseconds(1));
+
+            continue;
+        }
+
+        // no more steps than the queue has room for
+        t->sim.run(std::min(SIM_BATCH_STEPS, (int)(t->changes.space() - SIM_QUEUE_MARGIN) + 1));
+
+        t->pathShown.store(t->sim.pathShown);
+        t->playerPos.store(pack_position(t->player.x, t->player.y));
+
+        // the render thread may be asleep waiting for events
+        if (!t->changes.empty()) {
+            glfwPostEmptyEvent();
+        }
+
+        guard.unlock();
+
+        std::this_thread::yield();
+
+        guard.lock();
+    }
+}
+
+void SimulationThread::start(Map* map, SolveStrat strategy) {
+
+    // no cooldown, the thread steps as fast as it can
+    this->player = {.x = 0, .y = 0, .lastmoved = 0, .movecooldown = 0};
+
+    this->sim.map      = map;
+    this->sim.player   = &this->player;
+    this->sim.strategy = strategy;
+    this->sim.restart();
+
+    this->changes.create(SIM_QUEUE_SIZE);
+
+    map->changes = &this->changes;
+
+    this->running.store(false);
+    this->quit.store(false);
+    this->pathShown.store(false);
+    this->playerPos.store(pack_position(0, 0));
+
+    this->thread = std::thread(simulation_main, this);
+}
+
+void SimulationThread::stop() {
+
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+
+        this->quit.store(true);
+    }
+
+    this->wake.notify_one();
+
+    this->thread.join();
+
+    this->sim.map->changes = nullptr;
+}
+
+void SimulationThread::setRunning(bool run) {
+
+    if (this->running.exchange(run) == run) {
+        return;
+    }
+
+    if (run) {
+
+        std::lock_guard<std::mutex> guard(this->lock);
+
+        this->wake.notify_one();
+    }
+}
+
+// applies the states the solver published, render thread only
+void SimulationThread::drain(Map& map) {
+
+    CellChange change;
+
+    while (this->changes.pop(change)) {
+
+        map.cells[change.index].state = change.state;
+
+        map.markDirty(change.index % map.width, change.index / map.width);
+    }
+}
+
+// throws away published colors, only safe while holding lock (the solver can't push then)
+void SimulationThread::discard() {
+
+    CellChange change;
+
+    while (this->changes.pop(change)) {
+    }
+}
+
+glm::i32vec2 SimulationThread::playerPosition() {
+
+    uint64_t packed = this->playerPos.load();
+
+    return {(int32_t)(packed >> 32), (int32_t)(uint32_t)packed};
+}
+
+// starts over from x, y on a rebuilt map, only safe while holding lock
+void SimulationThread::restart(int x, int y) {
+
+    this->discard();
+
+    this->setPlayerPosition(x, y);
+
+    this->sim.restart();
+
+    this->pathShown.store(false);
+
+    this->wake.notify_one();
+}
+
+// only safe while holding lock
+void SimulationThread::setPlayerPosition(int x, int y) {
+
+    this->player.x = x;
+    this->player.y = y;
+
+    this->playerPos.store(pack_position(x, y));
+}
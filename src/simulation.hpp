@@ -0,0 +1,84 @@
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <stack>
+#include <thread>
+#include "glm/fwd.hpp"
+
+#include "solvers/solvers.hpp"
+#include "spscQueue.hpp"
+#include "world.hpp"
+
+// One solve of one maze. Stepped from the frame loop, or from a SimulationThread.
+struct Simulation {
+
+        Map*       map;
+        Player*    player;
+        SolveStrat strategy;
+
+        bool isSolved;
+        bool pathShown;
+
+        SolverStats stats;
+
+        std::stack<glm::i32vec2> visitHistory;
+        std::queue<glm::i32vec2> floodnext;
+
+        void step();
+        int  run(int maxSteps); // steps until the path is shown or maxSteps, timing them into stats
+        void restart();
+};
+
+// How much solving one frame gets when the Simulation is stepped from the frame loop.
+// Either a fixed number of steps, or as many as fit in a time budget. The time budget shrinks
+// when the rest of the frame leaves no room for it under targetFrame and grows back up to
+// maxBudget once it does.
+struct StepBudget {
+
+        int    steps;       // steps per frame, 0 switches to the time budget
+        double maxBudget;   // seconds
+        double budget;      // seconds, what the next frame gets
+        double targetFrame; // seconds
+        double spent;       // seconds the last run took
+
+        int  run(Simulation& sim);
+        void adapt(double frameTime);
+};
+
+// Runs a Simulation on its own thread as fast as the solver goes.
+// The solver owns the map (everything but cell colors) and its player while it steps and holds
+// lock for the duration of every batch, take the lock to touch either from another thread.
+// Cell colors belong to the render thread, they arrive through changes and are applied by drain.
+struct SimulationThread {
+
+        Simulation            sim;
+        Player                player;
+        SpscQueue<CellChange> changes;
+
+        std::thread             thread;
+        std::mutex              lock;
+        std::condition_variable wake;
+
+        std::atomic<bool>     running;
+        std::atomic<bool>     quit;
+        std::atomic<bool>     pathShown;
+        std::atomic<uint64_t> playerPos;
+
+        void start(Map* map, SolveStrat strategy);
+        void stop();
+        void setRunning(bool run);
+        void drain(Map& map);
+        void discard();
+        void restart(int x, int y);
+
+        glm::i32vec2 playerPosition();
+        void         setPlayerPosition(int x, int y);
+};
+
+#endif
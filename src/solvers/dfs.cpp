@@ -1,10 +1,11 @@
 
+#include <algorithm>
 #include <stack>
 #include "glm/fwd.hpp"
 
 #include "solvers.hpp"
 
-bool dfs_show_path(Map& map, Player& player, std::stack<glm::i32vec2>& history) {
+bool dfs_show_path(Map& map, Player& player, std::stack<glm::i32vec2>& history, SolverStats& stats) {
 
     if (player.lastmoved < player.movecooldown) {
         return true;
@@ -21,14 +22,16 @@ bool dfs_show_path(Map& map, Player& player, std::stack<glm::i32vec2>& history)
     player.x = pos.x;
     player.y = pos.y;
 
-    Cell* cell = map.at(pos.x, pos.y);
+    map.setState(pos.x, pos.y, CELL_PATH);
 
-    cell->color = ColorPath;
+    stats.pathLength++;
 
     return false;
 }
 
-void dfs_solve_maze(Map& map, Player& player, std::stack<glm::i32vec2>& history, bool& isSolved) {
+void dfs_solve_maze(
+    Map& map, Player& player, std::stack<glm::i32vec2>& history, bool& isSolved, SolverStats& stats
+) {
 
     if (player.lastmoved < player.movecooldown) {
         return;
@@ -47,7 +50,10 @@ void dfs_solve_maze(Map& map, Player& player, std::stack<glm::i32vec2>& history,
     Cell* cell = map.at(x, y);
 
     cell->visited = true;
-    cell->color   = ColorSearch;
+
+    map.setState(x, y, CELL_SEARCHED);
+
+    stats.cellsExpanded++;
 
     std::bitset<4> directions = {0b1111};
 
@@ -67,6 +73,8 @@ void dfs_solve_maze(Map& map, Player& player, std::stack<glm::i32vec2>& history,
         directions.reset(Direction::SOUTH);
     }
 
+    stats.wallChecks += 4;
+
     for (int i = 0; i < 4; i++) {
 
         if (!directions.test(i))
@@ -74,6 +82,8 @@ void dfs_solve_maze(Map& map, Player& player, std::stack<glm::i32vec2>& history,
 
         Direction move_to = Direction(i);
 
+        stats.wallChecks++;
+
         if (cell->wallAt(move_to))
             continue;
 
@@ -92,6 +102,8 @@ void dfs_solve_maze(Map& map, Player& player, std::stack<glm::i32vec2>& history,
         if (newCell->visited)
             continue;
 
+        stats.wallChecks++;
+
         if (newCell->wallOpposite(move_to))
             continue;
 
@@ -103,6 +115,8 @@ void dfs_solve_maze(Map& map, Player& player, std::stack<glm::i32vec2>& history,
 
         history.push({x, y});
 
+        stats.maxFrontier = std::max(stats.maxFrontier, history.size());
+
         return;
     }
 
@@ -1,7 +1,8 @@
 
+#include <algorithm>
 #include "solvers.hpp"
 
-bool floodfill_show_path(Map& map, Player& player) {
+bool floodfill_show_path(Map& map, Player& player, SolverStats& stats) {
 
     if (player.lastmoved < player.movecooldown) {
         return false;
@@ -16,9 +17,12 @@ bool floodfill_show_path(Map& map, Player& player) {
 
     if (maxDistance == 0) {
 
-        cell->color = ColorPath;
-        player.x    = x;
-        player.y    = y;
+        map.setState(x, y, CELL_PATH);
+
+        stats.pathLength++;
+
+        player.x = x;
+        player.y = y;
 
         return true;
     }
@@ -52,7 +56,9 @@ bool floodfill_show_path(Map& map, Player& player) {
             player.x = x;
             player.y = y;
 
-            cell->color = ColorPath;
+            map.setState(x, y, CELL_PATH);
+
+            stats.pathLength++;
 
             return false;
         }
@@ -60,7 +66,9 @@ bool floodfill_show_path(Map& map, Player& player) {
     return false;
 }
 
-void floodfill_solve_maze(Map& map, Player& player, std::queue<glm::i32vec2>& history, bool& isSolved) {
+void floodfill_solve_maze(
+    Map& map, Player& player, std::queue<glm::i32vec2>& history, bool& isSolved, SolverStats& stats
+) {
 
     if (player.lastmoved < player.movecooldown) {
         return;
@@ -79,7 +87,10 @@ void floodfill_solve_maze(Map& map, Player& player, std::queue<glm::i32vec2>& hi
     Cell* cell = map.at(x, y);
 
     cell->visited = true;
-    cell->color   = ColorSearch;
+
+    map.setState(x, y, CELL_SEARCHED);
+
+    stats.cellsExpanded++;
 
     std::bitset<4> directions = {0b1111};
 
@@ -99,6 +110,8 @@ void floodfill_solve_maze(Map& map, Player& player, std::queue<glm::i32vec2>& hi
         directions.reset(Direction::SOUTH);
     }
 
+    stats.wallChecks += 4;
+
     for (int i = 0; i < 4; i++) {
 
         if (!directions.test(i))
@@ -106,6 +119,8 @@ void floodfill_solve_maze(Map& map, Player& player, std::queue<glm::i32vec2>& hi
 
         Direction move_to = Direction(i);
 
+        stats.wallChecks++;
+
         if (cell->wallAt(move_to))
             continue;
 
@@ -124,6 +139,8 @@ void floodfill_solve_maze(Map& map, Player& player, std::queue<glm::i32vec2>& hi
         if (newCell->visited)
             continue;
 
+        stats.wallChecks++;
+
         if (newCell->wallOpposite(move_to))
             continue;
 
@@ -133,6 +150,8 @@ void floodfill_solve_maze(Map& map, Player& player, std::queue<glm::i32vec2>& hi
         newCell->visited = true;
 
         history.push({nx, ny});
+
+        stats.maxFrontier = std::max(stats.maxFrontier, history.size());
     }
 
     if (history.empty())
@@ -0,0 +1,20 @@
+
+#include <cstdio>
+#include "solvers.hpp"
+
+void SolverStats::format(char* out, size_t size, SolveStrat strategy) {
+
+    snprintf(
+        out,
+        size,
+        "%s: %llu expanded, frontier %zu (%zu bytes), path %d, %llu wall checks, search %.2f ms, path %.2f ms",
+        strategy == DFS ? "dfs" : "floodfill",
+        (unsigned long long)this->cellsExpanded,
+        this->maxFrontier,
+        this->peakWorkspaceBytes,
+        this->pathLength,
+        (unsigned long long)this->wallChecks,
+        this->searchTime * 1e3,
+        this->pathTime * 1e3
+    );
+}
@@ -2,6 +2,8 @@
 #ifndef SOLVERS_H
 #define SOLVERS_H
 
+#include <cstddef>
+#include <cstdint>
 #include <stack>
 #include <queue>
 #include "glm/fwd.hpp"
@@ -10,10 +12,30 @@
 
 typedef enum { DFS, FLOODFILL } SolveStrat;
 
-bool dfs_show_path(Map& map, Player& player, std::stack<glm::i32vec2>& history);
-void dfs_solve_maze(Map& map, Player& player, std::stack<glm::i32vec2>& history, bool& isSolved);
+// What one solve cost. The counters are bumped by the solvers as they step, the times and
+// workspace by Simulation::run, which is the only place that reads the clock.
+struct SolverStats {
 
-bool floodfill_show_path(Map& map, Player& player);
-void floodfill_solve_maze(Map& map, Player& player, std::queue<glm::i32vec2>& history, bool& isSolved);
+        uint64_t cellsExpanded;      // solve steps, dfs counts a cell again each time it backs into it
+        uint64_t wallChecks;
+        size_t   maxFrontier;        // most cells waiting in the stack or queue at once
+        size_t   peakWorkspaceBytes; // the frontier at its largest
+        int      pathLength;
+        double   searchTime;         // seconds spent stepping until solved
+        double   pathTime;           // seconds spent walking the path back
+
+        // one line, for the window title and headless output
+        void format(char* out, size_t size, SolveStrat strategy);
+};
+
+bool dfs_show_path(Map& map, Player& player, std::stack<glm::i32vec2>& history, SolverStats& stats);
+void dfs_solve_maze(
+    Map& map, Player& player, std::stack<glm::i32vec2>& history, bool& isSolved, SolverStats& stats
+);
+
+bool floodfill_show_path(Map& map, Player& player, SolverStats& stats);
+void floodfill_solve_maze(
+    Map& map, Player& player, std::queue<glm::i32vec2>& history, bool& isSolved, SolverStats& stats
+);
 
 #endif
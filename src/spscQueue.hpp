@@ -0,0 +1,79 @@
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Fixed size ring buffer for exactly one producer thread and one consumer thread.
+// Neither side ever blocks, push fails when full and pop fails when empty.
+template <typename T> struct SpscQueue {
+
+        std::vector<T> buffer;
+        size_t         mask;
+
+        // each index is only written by its own side, keep them on separate cache lines
+        alignas(64) std::atomic<size_t> head; // next slot to pop
+        alignas(64) std::atomic<size_t> tail; // next slot to push
+
+        // capacity is rounded up to a power of two
+        void create(size_t capacity) {
+
+            size_t size = 1;
+
+            while (size < capacity) {
+                size <<= 1;
+            }
+
+            this->buffer.resize(size);
+            this->mask = size - 1;
+
+            this->head.store(0, std::memory_order_relaxed);
+            this->tail.store(0, std::memory_order_relaxed);
+        }
+
+        bool push(const T& value) {
+
+            size_t tail = this->tail.load(std::memory_order_relaxed);
+
+            if (tail - this->head.load(std::memory_order_acquire) > this->mask) {
+                return false;
+            }
+
+            this->buffer[tail & this->mask] = value;
+
+            this->tail.store(tail + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        bool pop(T& value) {
+
+            size_t head = this->head.load(std::memory_order_relaxed);
+
+            if (head == this->tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            value = this->buffer[head & this->mask];
+
+            this->head.store(head + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        // only exact when called from the producer
+        size_t space() {
+
+            size_t used = this->tail.load(std::memory_order_relaxed) - this->head.load(std::memory_order_acquire);
+
+            return this->buffer.size() - used;
+        }
+
+        bool empty() {
+            return this->head.load(std::memory_order_acquire) == this->tail.load(std::memory_order_acquire);
+        }
+};
+
+#endif
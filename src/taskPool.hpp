@@ -0,0 +1,197 @@
+
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs tasks that push more tasks on a fixed set of threads, the calling one included.
+// Every thread keeps its own deque and works through it newest first, a thread that runs dry
+// steals the oldest task of another one, which is the biggest piece of work it has left.
+// The threads stay up from start to stop, so a pool can run many small batches in a row.
+template <typename T> struct TaskPool {
+
+        typedef std::function<void(const T& task, int worker)> Job;
+
+        struct Worker {
+
+                std::mutex    lock;
+                std::deque<T> tasks;
+        };
+
+        std::unique_ptr<Worker[]> workers;
+        int                       threads;
+
+        // pushed and not finished yet, a running task counts until it returns
+        std::atomic<size_t> pending;
+
+        // helpers sleep on wake between batches, generation tells them a new one started
+        std::vector<std::thread> helpers;
+        std::mutex               lock;
+        std::condition_variable  wake;
+        std::condition_variable  idle;
+        Job                      job;
+        unsigned                 generation;
+        int                      busy; // helpers still in the current batch
+        bool                     quit;
+
+        void start(int threads) {
+
+            this->workers.reset(new Worker[threads]);
+            this->threads = threads;
+
+            this->pending.store(0, std::memory_order_relaxed);
+
+            this->generation = 0;
+            this->busy       = 0;
+            this->quit       = false;
+
+            for (int t = 1; t < threads; t++) {
+                this->helpers.emplace_back([this, t]() { this->helper(t); });
+            }
+        }
+
+        void stop() {
+
+            {
+                std::lock_guard<std::mutex> guard(this->lock);
+
+                this->quit = true;
+            }
+
+            this->wake.notify_all();
+
+            for (std::thread& helper : this->helpers) {
+                helper.join();
+            }
+
+            this->helpers.clear();
+        }
+
+        // only from inside a task, worker is the one running it
+        void push(int worker, const T& task) {
+
+            this->pending.fetch_add(1, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> guard(this->workers[worker].lock);
+
+            this->workers[worker].tasks.push_back(task);
+        }
+
+        bool take(int worker, T& task) {
+
+            for (int i = 0; i < this->threads; i++) {
+
+                Worker& from = this->workers[(worker + i) % this->threads];
+
+                std::lock_guard<std::mutex> guard(from.lock);
+
+                if (from.tasks.empty()) {
+                    continue;
+                }
+
+                // our own newest, anyone else's oldest
+                if (i == 0) {
+                    task = from.tasks.back();
+                    from.tasks.pop_back();
+                } else {
+                    task = from.tasks.front();
+                    from.tasks.pop_front();
+                }
+
+                return true;
+            }
+
+            return false;
+        }
+
+        void work(int worker) {
+
+            T task;
+
+            while (this->pending.load(std::memory_order_acquire) > 0) {
+
+                if (!this->take(worker, task)) {
+
+                    std::this_thread::yield();
+
+                    continue;
+                }
+
+                this->job(task, worker);
+
+                this->pending.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        }
+
+        void helper(int worker) {
+
+            unsigned seen = 0;
+
+            std::unique_lock<std::mutex> guard(this->lock);
+
+            while (true) {
+
+                this->wake.wait(guard, [&]() { return this->quit || this->generation != seen; });
+
+                if (this->quit) {
+                    return;
+                }
+
+                seen = this->generation;
+
+                guard.unlock();
+
+                this->work(worker);
+
+                guard.lock();
+
+                if (--this->busy == 0) {
+                    this->idle.notify_one();
+                }
+            }
+        }
+
+        // calls job(task, worker) for every task and everything pushed from them,
+        // returns once all of it is done and every helper is back asleep
+        void run(const std::vector<T>& tasks, Job job) {
+
+            if (tasks.empty()) {
+                return;
+            }
+
+            this->job = std::move(job);
+
+            for (const T& task : tasks) {
+                this->push(0, task);
+            }
+
+            {
+                std::lock_guard<std::mutex> guard(this->lock);
+
+                this->generation++;
+                this->busy = (int)this->helpers.size();
+            }
+
+            this->wake.notify_all();
+
+            this->work(0);
+
+            // the next batch swaps job out from under them otherwise
+            std::unique_lock<std::mutex> guard(this->lock);
+
+            this->idle.wait(guard, [this]() { return this->busy == 0; });
+        }
+
+        void run(const T& root, Job job) {
+            this->run(std::vector<T>{root}, std::move(job));
+        }
+};
+
+#endif
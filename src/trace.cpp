@@ -0,0 +1,159 @@
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include "trace.hpp"
+
+// per thread, a power of two
+constexpr size_t TRACE_EVENTS = 1 << 16;
+
+static bool     enabled;
+static uint64_t epoch;
+
+// only touched when a thread records its first zone and when dumping
+static std::mutex                registryLock;
+static std::vector<TraceBuffer*> registry;
+
+static thread_local TraceBuffer* localBuffer;
+
+static uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// buffers are kept after their thread exits so its zones still make the dump
+static TraceBuffer* local_buffer() {
+
+    if (localBuffer) {
+        return localBuffer;
+    }
+
+    TraceBuffer* buffer = new TraceBuffer();
+
+    buffer->events.resize(TRACE_EVENTS);
+    buffer->written.store(0, std::memory_order_relaxed);
+    buffer->threadName = nullptr;
+
+    std::lock_guard<std::mutex> guard(registryLock);
+
+    buffer->thread = (int)registry.size() + 1;
+
+    registry.push_back(buffer);
+
+    localBuffer = buffer;
+
+    return buffer;
+}
+
+void trace_enable() {
+
+    epoch   = now_ns();
+    enabled = true;
+}
+
+bool trace_enabled() {
+    return enabled;
+}
+
+void trace_thread_name(const char* name) {
+
+    if (enabled) {
+        local_buffer()->threadName = name;
+    }
+}
+
+TraceZone::TraceZone(const char* name) {
+
+    this->name  = name;
+    this->start = enabled ? now_ns() : 0;
+}
+
+TraceZone::~TraceZone() {
+
+    if (!enabled) {
+        return;
+    }
+
+    uint64_t end = now_ns();
+
+    TraceBuffer* buffer = local_buffer();
+
+    uint64_t index = buffer->written.load(std::memory_order_relaxed);
+
+    buffer->events[index & (TRACE_EVENTS - 1)] = {
+        .name     = this->name,
+        .start    = this->start - epoch,
+        .duration = end - this->start,
+    };
+
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+bool trace_dump(const char* path) {
+
+    FILE* file = fopen(path, "w");
+
+    if (!file) {
+        return false;
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+
+    std::lock_guard<std::mutex> guard(registryLock);
+
+    std::vector<TraceEvent> copy;
+
+    bool first = true;
+
+    for (TraceBuffer* buffer : registry) {
+
+        if (buffer->threadName) {
+
+            fprintf(
+                file,
+                "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n",
+                buffer->thread,
+                buffer->threadName
+            );
+
+            first = false;
+        }
+
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        uint64_t from    = written > TRACE_EVENTS ? written - TRACE_EVENTS : 0;
+
+        copy.clear();
+
+        for (uint64_t i = from; i < written; i++) {
+            copy.push_back(buffer->events[i & (TRACE_EVENTS - 1)]);
+        }
+
+        // anything the owner wrapped around onto while we copied is garbage, and so is the slot
+        // of event after, which it may be halfway through writing right now
+        uint64_t after = buffer->written.load(std::memory_order_acquire);
+        uint64_t valid = after + 1 > TRACE_EVENTS ? after + 1 - TRACE_EVENTS : 0;
+
+        for (uint64_t i = std::max(from, valid); i < written; i++) {
+
+            TraceEvent& event = copy[i - from];
+
+            fprintf(
+                file,
+                "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",\n",
+                event.name,
+                buffer->thread,
+                event.start / 1e3,
+                event.duration / 1e3
+            );
+
+            first = false;
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+
+    return fclose(file) == 0;
+}
@@ -0,0 +1,54 @@
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Scoped timing zones dumped as a Chrome trace (chrome://tracing, ui.perfetto.dev).
+// Every thread records into its own ring buffer without locks, the newest TRACE_EVENTS zones
+// per thread survive. Nothing is recorded until trace_enable, a zone then costs two clock reads.
+
+struct TraceEvent {
+
+        const char* name;     // must outlive the trace, string literals
+        uint64_t    start;    // ns since trace_enable
+        uint64_t    duration; // ns
+};
+
+// written only by its own thread, read by trace_dump
+struct TraceBuffer {
+
+        std::vector<TraceEvent> events;
+        std::atomic<uint64_t>   written;
+        int                     thread;
+        const char*             threadName;
+};
+
+struct TraceZone {
+
+        const char* name;
+        uint64_t    start;
+
+        TraceZone(const char* name);
+        ~TraceZone();
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b)  TRACE_CONCAT_(a, b)
+
+// times the rest of the enclosing scope
+#define TRACE_ZONE(name) TraceZone TRACE_CONCAT(traceZone, __LINE__)(name)
+
+// call once before the threads being traced start
+void trace_enable();
+bool trace_enabled();
+
+// names the calling thread in the trace
+void trace_thread_name(const char* name);
+
+// safe while other threads keep recording, zones they overwrite during the dump are dropped
+bool trace_dump(const char* path);
+
+#endif
@@ -1,9 +1,22 @@
 
+#include <algorithm>
 #include <bitset>
+#include <cmath>
 #include <iostream>
+#include "generators/generators.hpp"
+#include "io/recording.hpp"
 #include "openglErrorReporting.h"
+#include "random.hpp"
+#include "trace.hpp"
 #include "world.hpp"
 
+gl2d::Color4f cellPalette[CELL_STATE_COUNT] = {
+    ColorBG,      // CELL_EMPTY
+    ColorSearch,  // CELL_SEARCHED
+    ColorPath,    // CELL_PATH
+    Colors_Green, // CELL_FINISH
+};
+
 Direction opposite_direction(Direction d) {
     switch (d) {
     case NORTH:
@@ -71,47 +84,147 @@ Cell* Map::at(int x, int y) {
 }
 
 size_t Map::length() {
-    return this->width * this->height;
+    return (size_t)this->width * this->height;
+}
+
+void Map::setState(int x, int y, CellState state) {
+
+    if (this->recorder) {
+        this->recorder->cellChanged(this->rawIndex(x, y), state);
+    }
+
+    if (this->changes) {
+
+        // the solver thread never blocks, SimulationThread keeps room in the queue for every step
+        this->changes->push({this->rawIndex(x, y), state});
+
+        return;
+    }
+
+    this->at(x, y)->state = state;
+
+    this->markDirty(x, y);
+}
+
+void Map::markDirty(int x, int y) {
+
+    if (this->allDirty) {
+        return;
+    }
+
+    // past this point a full upload is cheaper than walking the list
+    if (this->dirtyCells.size() >= this->length() / 8) {
+
+        this->markAllDirty();
+
+        return;
+    }
+
+    this->dirtyCells.push_back(this->rawIndex(x, y));
+}
+
+void Map::markAllDirty() {
+
+    this->allDirty = true;
+
+    this->dirtyCells.clear();
+}
+
+void Map::clearDirty() {
+
+    this->allDirty = false;
+
+    this->dirtyCells.clear();
+    this->wallChanges.clear();
 }
 
-static void build_maze_recur(Map* map, int x, int y) {
+// one cell on the backtracker's path, with the directions it hasn't tried yet
+struct CarveFrame {
+
+        int     x;
+        int     y;
+        uint8_t directions;
+};
 
-    Cell* cell = map->at(x, y);
+static CarveFrame carve_enter(Map* map, int x, int y) {
 
-    cell->visited = true;
+    map->at(x, y)->visited = true;
 
-    std::bitset<4> directions = {0b1111};
+    uint8_t directions = 0b1111;
 
     if (x <= 0) {
-        directions.reset(Direction::WEST);
+        directions &= ~(1 << WEST);
     }
 
     if (x >= map->width - 1) {
-        directions.reset(Direction::EAST);
+        directions &= ~(1 << EAST);
     }
 
     if (y <= 0) {
-        directions.reset(Direction::NORTH);
+        directions &= ~(1 << NORTH);
     }
 
     if (y >= map->height - 1) {
-        directions.reset(Direction::SOUTH);
+        directions &= ~(1 << SOUTH);
+    }
+
+    return {x, y, directions};
+}
+
+// lets whoever draws the maze see a passage as soon as it's carved
+void publish_walls(Map* map, Cell* cell) {
+
+    uint8_t walls = 0;
+
+    for (int d = 0; d < 4; d++) {
+        walls |= cell->walls[d] << d;
     }
 
-    for (;;) {
+    bool wasEmpty = map->carves->empty();
+
+    // the render thread is behind, it gets the rest with the finished maze
+    if (!map->carves->push({(int)(cell - map->cells), walls})) {
+
+        map->carves = nullptr;
+
+        return;
+    }
+
+    // it may be asleep waiting for events after draining everything
+    if (wasEmpty) {
+        glfwPostEmptyEvent();
+    }
+}
+
+// Depth first backtracker with its own stack, so big mazes don't need a big thread stack.
+// Draws the same numbers in the same order as the recursive version did, a seed keeps its maze.
+static void carve_backtracker(Map* map, Random& random, int x, int y) {
+
+    std::vector<CarveFrame> path;
+
+    path.push_back(carve_enter(map, x, y));
+
+    while (!path.empty()) {
 
-        if (directions.count() == 0) {
-            return;
+        CarveFrame& frame = path.back();
+
+        if (frame.directions == 0) {
+
+            path.pop_back();
+
+            continue;
         }
 
-        Direction move_to = Direction(rand() % 4);
+        Direction move_to = Direction(random.next() % 4);
 
-        if (!directions.test(move_to)) {
+        if (!(frame.directions >> move_to & 1)) {
             continue;
         }
 
-        int nx = x;
-        int ny = y;
+        frame.directions &= ~(1 << move_to);
+
+        int nx = frame.x;
+        int ny = frame.y;
 
         switch (move_to) {
         case NORTH: ny--; break;
@@ -120,71 +233,176 @@ static void build_maze_recur(Map* map, int x, int y) {
         case WEST : nx--; break;
         }
 
-        if (!cell->wallAt(move_to)) {
-
-            directions.reset(move_to);
+        Cell* cell = map->at(frame.x, frame.y);
 
+        if (!cell->wallAt(move_to)) {
             continue;
         }
 
         Cell* newCell = map->at(nx, ny);
 
         if (!newCell->wallOpposite(move_to)) {
-
-            directions.reset(move_to);
-
             continue;
         }
 
         if (newCell->visited) {
 
-            directions.reset(move_to);
-
-            if ((rand() % 100) < map->percentLessWalls) {
+            if ((random.next() % 100) < map->percentLessWalls) {
                 cell->removeWall(move_to);
                 newCell->removeWall(opposite_direction(move_to));
+
+                if (map->carves) {
+                    publish_walls(map, cell);
+                    publish_walls(map, newCell);
+                }
             }
 
             continue;
         }
 
-        directions.reset(move_to);
-
         cell->removeWall(move_to);
 
         newCell->removeWall(opposite_direction(move_to));
 
-        build_maze_recur(map, nx, ny);
+        if (map->carves) {
+            publish_walls(map, cell);
+            publish_walls(map, newCell);
+        }
+
+        // frame is gone once the path grows
+        path.push_back(carve_enter(map, nx, ny));
     }
 }
 
 void Map::buildRandomMaze() {
+    this->buildMaze(rand());
+}
+
+void Map::buildMaze(unsigned seed) {
 
-    size_t len = this->length();
+    this->generate(seed);
 
-    for (int i = 0; i < len; i++) {
+    this->mazeChanged();
+}
 
-        this->cells[i] = {.color = ColorBG, .walls = {1, 1, 1, 1}, .visited = false};
+void Map::generate(unsigned seed) {
+
+    TRACE_ZONE("buildMaze");
+
+    this->seed = seed;
+
+    glm::i32vec2 finish;
+
+    switch (this->generator) {
+    case GEN_DIVISION:
+        finish = division_carve_maze(*this, seed);
+        break;
+    case GEN_BINARY_TREE:
+        finish = binary_tree_carve_maze(*this, seed);
+        break;
+    case GEN_SIDEWINDER:
+        finish = sidewinder_carve_maze(*this, seed);
+        break;
+    case GEN_HUNT_AND_KILL:
+        finish = hunt_and_kill_carve_maze(*this, seed);
+        break;
+    default:
+        finish = backtracker_carve_maze(*this, seed);
+        break;
     }
 
-    int start_x = rand() % this->width;
-    int start_y = rand() % this->height;
+    this->at(finish.x, finish.y)->state = CELL_FINISH;
+    this->finishPos                     = finish;
+}
+
+glm::i32vec2 backtracker_carve_maze(Map& map, unsigned seed) {
+
+    Random random;
+
+    random.seed(seed);
+
+    size_t len = map.length();
 
-    build_maze_recur(this, start_x, start_y);
+    for (size_t i = 0; i < len; i++) {
 
-    for (int i = 0; i < this->length(); i++) {
-        this->cells[i].visited  = false;
-        this->cells[i].distance = 0;
+        map.cells[i] = {.state = CELL_EMPTY, .walls = {1, 1, 1, 1}, .visited = false};
     }
 
-    this->at(start_x, start_y)->color = Colors_Green;
-    this->finishPos                   = glm::i32vec2(start_x, start_y);
+    int start_x = random.next() % map.width;
+    int start_y = random.next() % map.height;
+
+    carve_backtracker(&map, random, start_x, start_y);
+
+    for (size_t i = 0; i < len; i++) {
+        map.cells[i].visited  = false;
+        map.cells[i].distance = 0;
+    }
+
+    return glm::i32vec2(start_x, start_y);
+}
+
+void Map::mazeChanged() {
+
+    if (this->recorder) {
+        this->recorder->beginMaze(*this);
+    }
+
+    this->wallsVersion++;
+
+    this->markAllDirty();
+}
+
+void Map::swapMaze(Map& other) {
+
+    std::swap(this->cells, other.cells);
+    std::swap(this->finishPos, other.finishPos);
+    std::swap(this->generator, other.generator);
+    std::swap(this->seed, other.seed);
+
+    this->mazeChanged();
 }
 
 static void error_callback(int error, const char* description) {
     std::cout << "Error: " << error << " " << description << "\n";
 }
 
+static void scroll_callback(GLFWwindow* window, double, double yoffset) {
+
+    World* world = (World*)glfwGetWindowUserPointer(window);
+
+    world->scrollDelta += yoffset;
+    world->needsRedraw = true;
+}
+
+static void key_callback(GLFWwindow* window, int, int, int action, int) {
+
+    World* world = (World*)glfwGetWindowUserPointer(window);
+
+    if (action == GLFW_PRESS) {
+        world->keysDown++;
+    } else if (action == GLFW_RELEASE && world->keysDown > 0) {
+        world->keysDown--;
+    }
+
+    world->needsRedraw = true;
+}
+
+static void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+
+    World* world = (World*)glfwGetWindowUserPointer(window);
+
+    world->screenWidth  = width;
+    world->screenHeight = height;
+    world->needsRedraw  = true;
+}
+
+static void refresh_callback(GLFWwindow* window) {
+
+    World* world = (World*)glfwGetWindowUserPointer(window);
+
+    world->needsRedraw = true;
+}
+
 void World::initGLFW() {
 
     glfwSetErrorCallback(error_callback);
@@ -195,6 +413,10 @@ void World::initGLFW() {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 
+    if (this->glDebug) {
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+    }
+
     GLFWwindow* window = glfwCreateWindow(this->screenWidth, this->screenHeight, "Simple example", NULL, NULL);
 
     if (!window) {
@@ -204,6 +426,13 @@ void World::initGLFW() {
 
     this->glwin = window;
 
+    glfwSetWindowUserPointer(window, this);
+    glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetWindowRefreshCallback(window, refresh_callback);
+    glfwGetCursorPos(window, &this->mouseX, &this->mouseY);
+
     glfwMakeContextCurrent(window);
 
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
@@ -211,7 +440,13 @@ void World::initGLFW() {
         exit(EXIT_FAILURE);
     }
 
-    enableReportGlErrors();
+    if (this->swapInterval >= 0) {
+        glfwSwapInterval(this->swapInterval);
+    }
+
+    if (this->glDebug && !enableReportGlErrors()) {
+        std::cout << "GL debug output is not supported by this context\n";
+    }
 }
 
 void World::initGL2D() {
@@ -219,6 +454,14 @@ void World::initGL2D() {
     gl2d::init();
 
     this->r2d.create();
+
+    this->grid.create();
+
+    this->overview.create();
+
+    this->walls.invalidate();
+
+    this->gpuTimer.create();
 }
 
 void World::updateTime() {
@@ -229,8 +472,22 @@ void World::updateTime() {
     this->lastTime  = currentTime;
 }
 
+// anything on screen that differs from the last frame drawn
+bool World::frameChanged() {
+
+    return this->needsRedraw || this->map.allDirty || !this->map.dirtyCells.empty() ||
+           this->drawnPlayer != glm::i32vec2(this->player.x, this->player.y) ||
+           this->drawnCamera.position != this->camera.position || this->drawnCamera.zoom != this->camera.zoom;
+}
+
 void World::beginFrame() {
 
+    TRACE_ZONE("beginFrame");
+
+    this->needsRedraw = false;
+    this->drawnPlayer = {this->player.x, this->player.y};
+    this->drawnCamera = this->camera;
+
     glfwGetFramebufferSize(this->glwin, &this->screenWidth, &this->screenHeight);
 
     glViewport(0, 0, this->screenWidth, this->screenHeight);
@@ -238,54 +495,201 @@ void World::beginFrame() {
     glClear(GL_COLOR_BUFFER_BIT);
 
     this->r2d.updateWindowMetrics(this->screenWidth, this->screenHeight);
+
+    this->r2d.setCamera(this->camera);
 }
 
 void World::endFrame() {
 
-    this->r2d.flush();
+    {
+        TRACE_ZONE("flush");
+
+        this->gpuTimer.begin(GPU_PASS_FLUSH);
+
+        this->r2d.flush();
+
+        this->gpuTimer.end();
+    }
+
+    TRACE_ZONE("swapBuffers");
 
     glfwSwapBuffers(this->glwin);
 
-    glfwPollEvents();
+    this->gpuTimer.endFrame();
+}
+
+void World::waitEvents(double timeout) {
+
+    if (timeout > 0) {
+        glfwWaitEventsTimeout(timeout);
+    } else {
+        glfwPollEvents();
+    }
+}
+
+// zooms while keeping the world point under (screenX, screenY) where it is
+void World::zoomCamera(float factor, float screenX, float screenY) {
+
+    float mapSize  = std::max(this->map.width, this->map.height) * (float)this->cellSize;
+    float viewSize = std::min(this->screenWidth, this->screenHeight);
+
+    float minZoom = viewSize / mapSize / 2;
+    float maxZoom = viewSize / this->cellSize / 2;
+
+    glm::vec2 center = {this->screenWidth / 2.0f, this->screenHeight / 2.0f};
+    glm::vec2 screen = {screenX, screenY};
+
+    glm::vec2 world = (screen - center) / this->camera.zoom + center + this->camera.position;
+
+    this->camera.zoom     = std::clamp(this->camera.zoom * factor, std::min(minZoom, maxZoom), maxZoom);
+    this->camera.position = world - (screen - center) / this->camera.zoom - center;
+}
+
+void World::updateCamera() {
+
+    double x;
+    double y;
+
+    glfwGetCursorPos(this->glwin, &x, &y);
+
+    // cursor positions are in window coordinates, the camera works in framebuffer pixels
+    int windowWidth;
+    int windowHeight;
+
+    glfwGetWindowSize(this->glwin, &windowWidth, &windowHeight);
+
+    float scale = windowWidth > 0 ? (float)this->screenWidth / windowWidth : 1;
+
+    if (glfwGetMouseButton(this->glwin, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
+
+        if (x != this->mouseX || y != this->mouseY) {
+
+            this->fitCamera    = false;
+            this->followPlayer = false;
+
+            this->camera.position.x -= (x - this->mouseX) * scale / this->camera.zoom;
+            this->camera.position.y -= (y - this->mouseY) * scale / this->camera.zoom;
+        }
+    }
+
+    this->mouseX = x;
+    this->mouseY = y;
+
+    if (this->scrollDelta != 0) {
+
+        this->fitCamera = false;
+
+        this->zoomCamera(std::pow(1.2f, (float)this->scrollDelta), x * scale, y * scale);
+
+        this->scrollDelta = 0;
+    }
+
+    if (this->fitCamera) {
+
+        float mapWidth  = this->map.width * (float)this->cellSize;
+        float mapHeight = this->map.height * (float)this->cellSize;
+
+        this->camera.zoom = std::min(this->screenWidth / mapWidth, this->screenHeight / mapHeight);
+
+        this->camera.position.x = (mapWidth - this->screenWidth) / 2;
+        this->camera.position.y = (mapHeight - this->screenHeight) / 2;
+
+        return;
+    }
+
+    if (this->followPlayer) {
+
+        glm::vec2 target = {
+            (this->player.x + 0.5f) * this->cellSize,
+            (this->player.y + 0.5f) * this->cellSize,
+        };
+
+        float speed = this->cellSize * 30 * this->deltaTime / std::min(this->camera.zoom, 1.0f);
+
+        float maxDistance = this->screenWidth / this->camera.zoom;
+
+        this->camera.follow(target, speed, 0.5f, maxDistance, this->screenWidth, this->screenHeight);
+    }
 }
 
+// the fill only, renderMap adds the walls from the mesh
 void World::renderCell(Cell* cell, int x, int y) {
 
     x *= this->cellSize;
     y *= this->cellSize;
 
-    r2d.renderRectangle({x, y, this->cellSize, this->cellSize}, cell->color);
+    r2d.renderSolidRectangle({x, y, this->cellSize, this->cellSize}, cellPalette[cell->state]);
+}
 
-    if (cell->walls[Direction::NORTH]) {
-        r2d.renderRectangle({x, y, this->cellSize, this->wallWidth}, ColorWall);
+void World::renderMap() {
+
+    TRACE_ZONE("renderMap");
+
+    // below a pixel per cell the maze is drawn from the mip pyramid instead
+    bool useOverview = this->cellSize * this->r2d.currentCamera.zoom < 1 && this->overview.supports(this->map);
+    bool useGrid     = !useOverview && this->renderMode == RENDER_GRID && this->grid.supports(this->map);
+    bool changed     = this->map.allDirty || !this->map.dirtyCells.empty();
+
+    if (useOverview) {
+        this->overview.upload(this->map, this->cellSize, this->wallWidth);
+    } else if (changed) {
+        this->overview.invalidate();
     }
 
-    if (cell->walls[Direction::SOUTH]) {
-        r2d.renderRectangle({x, y + this->cellSize - this->wallWidth, this->cellSize, this->wallWidth}, ColorWall);
+    if (useGrid) {
+        this->grid.upload(this->map);
+    } else if (changed) {
+        this->grid.invalidate();
     }
 
-    if (cell->walls[Direction::WEST]) {
-        r2d.renderRectangle({x, y, this->wallWidth, this->cellSize}, ColorWall);
+    this->walls.update(this->map);
+
+    this->map.clearDirty();
+
+    if (useOverview) {
+
+        this->overview.render(this->r2d, this->map, this->cellSize);
+
+        return;
     }
 
-    if (cell->walls[Direction::EAST]) {
-        r2d.renderRectangle({x + this->cellSize - this->wallWidth, y, this->wallWidth, this->cellSize}, ColorWall);
+    if (useGrid) {
+
+        // the only pass that draws straight away, the overview and the quads wait for the flush
+        this->gpuTimer.begin(GPU_PASS_GRID);
+
+        this->grid.render(
+            this->map, this->r2d.currentCamera, this->screenWidth, this->screenHeight, this->cellSize, this->wallWidth
+        );
+
+        this->gpuTimer.end();
+
+        return;
     }
-}
 
-void World::renderMap() {
+    // only submit the cells that intersect the view
+    glm::vec4 view = this->r2d.getViewRect();
 
-    for (int y = 0; y < map.height; y++) {
+    int x0 = std::max((int)std::floor(view.x / this->cellSize), 0);
+    int y0 = std::max((int)std::floor(view.y / this->cellSize), 0);
+    int x1 = std::min((int)std::ceil((view.x + view.z) / this->cellSize), map.width);
+    int y1 = std::min((int)std::ceil((view.y + view.w) / this->cellSize), map.height);
 
-        for (int x = 0; x < map.width; x++) {
+    for (int y = y0; y < y1; y++) {
+
+        for (int x = x0; x < x1; x++) {
 
             int i = y * map.width + x;
 
             renderCell(map.cells + i, x, y);
         }
     }
+
+    // walls go on top as merged runs, a cell's fill never reaches into its neighbours walls
+    this->walls.render(this->r2d, this->map, x0, y0, x1, y1, this->cellSize, this->wallWidth);
 }
 
+// a regular quad, solid rectangles would end up under the overview texture
 void World::renderPlayer() {
 
     r2d.renderRectangle(
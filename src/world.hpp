@@ -4,7 +4,14 @@
 
 #include "GLFW/glfw3.h"
 #include "gl2d/gl2d.h"
+#include "render/gpuTimer.hpp"
+#include "render/gridRenderer.hpp"
+#include "render/overviewRenderer.hpp"
+#include "render/wallMesh.hpp"
+#include "spscQueue.hpp"
 #include <bitset>
+#include <cstdint>
+#include <vector>
 
 #define NEWCOLOR(r, g, b) (gl2d::Color4f{(float)(r) / 255.0f, (float)(g) / 255.0f, (float)(b) / 255.0f, 1})
 #define ColorBG NEWCOLOR(0x1f, 0x1f, 0x1f)
@@ -15,14 +22,26 @@
 
 typedef enum { NORTH = 0, SOUTH, EAST, WEST } Direction;
 
+typedef enum { RENDER_QUADS, RENDER_GRID } RenderMode;
+
+// what a cell shows, turned into a color through cellPalette only when it is drawn
+typedef enum : uint8_t { CELL_EMPTY = 0, CELL_SEARCHED, CELL_PATH, CELL_FINISH, CELL_STATE_COUNT } CellState;
+
+// indexed by CellState, changes show from the next frame on without touching the map
+// (the overview also needs Map::markAllDirty, it keeps cells shaded)
+extern gl2d::Color4f cellPalette[CELL_STATE_COUNT];
+
+// how a maze was carved, kept with saved mazes
+typedef enum { GEN_BACKTRACKER = 0, GEN_DIVISION, GEN_BINARY_TREE, GEN_SIDEWINDER, GEN_HUNT_AND_KILL } Generator;
+
 Direction opposite_direction(Direction d);
 
 struct Cell {
 
-        gl2d::Color4f color;
-        bool          walls[4];
-        bool          visited;
-        int           distance;
+        uint8_t state; // a CellState, or a recording's own palette index when replaying one
+        bool    walls[4];
+        bool    visited;
+        int     distance;
 
         void           addWall(Direction d);
         void           removeWall(Direction d);
@@ -39,6 +58,22 @@ struct Player {
         float movecooldown;
 };
 
+struct Recorder;
+
+// a cell state published by the solver thread for the render thread to apply
+struct CellChange {
+
+        int       index;
+        CellState state;
+};
+
+// the walls of a cell after a generator on another thread carved through them
+struct WallChange {
+
+        int     index;
+        uint8_t walls; // bit per Direction
+};
+
 struct Map {
 
         glm::i32vec2 finishPos;
@@ -48,18 +83,63 @@ struct Map {
         int width;
         int height;
 
+        // rebuilding with the same generator and seed gives back the same maze,
+        // generate uses the one set here
+        Generator generator;
+        unsigned  seed;
+
+        // cells changed since the renderer last looked, everything is stale when allDirty is set
+        std::vector<int> dirtyCells;
+        bool             allDirty;
+
+        // set while a SimulationThread solves this map, states go through it instead of the cells
+        SpscQueue<CellChange>* changes;
+
+        // set while a MazeBuilder shows this maze being generated, every carved cell is also
+        // published here, dropped by the generator if the queue fills up
+        SpscQueue<WallChange>* carves;
+
+        // set while recording, sees every state change and rebuild
+        Recorder* recorder;
+
+        // bumped whenever the walls change, for geometry cached across frames
+        unsigned wallsVersion;
+
+        // cells whose walls changed one at a time since the renderer last looked, the rest of
+        // the maze is still what wallsVersion says
+        std::vector<int> wallChanges;
+
         bool   canMove(int x, int y, Direction d);
         bool   canMove(int x, int y);
         Cell*  at(int x, int y);
         int    rawIndex(int x, int y);
         void   buildRandomMaze();
+        void   buildMaze(unsigned seed);
         size_t length();
+
+        // carves a new maze into cells and nothing else, safe on any thread that owns them
+        void generate(unsigned seed);
+
+        // tells the recorder and renderers the walls were replaced
+        void mazeChanged();
+
+        // trades mazes (cells and what describes them) with other, which must be the same size
+        void swapMaze(Map& other);
+
+        void setState(int x, int y, CellState state);
+        void markDirty(int x, int y);
+        void markAllDirty();
+        void clearDirty();
 };
 
 struct World {
 
     public:
         gl2d::Renderer2D r2d;
+        GridRenderer     grid;
+        OverviewRenderer overview;
+        WallMesh         walls;
+        GpuTimer         gpuTimer;
         GLFWwindow*      glwin;
 
         Map    map;
@@ -73,11 +153,32 @@ struct World {
         int cellSize;
         int wallWidth;
 
+        RenderMode renderMode;
+
+        gl2d::Camera camera;
+        bool         fitCamera;    // keep the whole map in view until the user pans or zooms
+        bool         followPlayer;
+        double       scrollDelta;
+        double       mouseX;
+        double       mouseY;
+
+        bool         needsRedraw;  // set by window and input events
+        int          keysDown;
+        int          swapInterval; // -1 leaves the driver default
+        bool         glDebug;      // debug context with messages logged through drainGlErrors
+        glm::i32vec2 drawnPlayer;
+        gl2d::Camera drawnCamera;
+
         void initGLFW();
         void initGL2D();
         void updateTime();
+        bool frameChanged();
         void beginFrame();
         void endFrame();
+        void waitEvents(double timeout);
+
+        void zoomCamera(float factor, float screenX, float screenY);
+        void updateCamera();
 
         void renderCell(Cell* cell, int x, int y);
         void renderMap();
@@ -1,5 +1,5 @@
 //////////////////////////////////////////////////
-//gl2d.h				1.5.0
+//gl2d.h				1.5.2
 //Copyright(c) 2020 Luta Vlad
 //https://github.com/meemknight/gl2d
 //
@@ -52,6 +52,9 @@
 //this is the default capacity of the renderer
 #define GL2D_DefaultTextureCoords (glm::vec4{ 0, 1, 1, 0 })
 
+//frames of vertices the renderer keeps in flight in its streaming buffer
+#define GL2D_Renderer2D_Stream_Sections 3
+
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <random>
@@ -321,15 +324,6 @@ namespace gl2d
 	};
 
 
-	enum Renderer2DBufferType
-	{
-		quadPositions,
-		quadColors,
-		texturePositions,
-
-		bufferSize
-	};
-
 	struct Renderer2D
 	{
 		Renderer2D() {};
@@ -353,24 +347,51 @@ namespace gl2d
 
 		GLuint defaultFBO = 0;
 
-		GLuint buffers[Renderer2DBufferType::bufferSize] = {};
 		GLuint vao = {};
 
-		//4 elements each component
-		std::vector<glm::vec2>spritePositions;
-		std::vector<glm::vec4>spriteColors;
-		std::vector<glm::vec2>texturePositions;
-		std::vector<Texture>spriteTextures;
-		
-		//glm::vec2 spritePositions[GL2D_Renderer2D_Max_Triangle_Capacity * 6];
-		//glm::vec4 spriteColors[GL2D_Renderer2D_Max_Triangle_Capacity * 6];
-		//glm::vec2 texturePositions[GL2D_Renderer2D_Max_Triangle_Capacity * 6];
-		//Texture   spriteTextures[GL2D_Renderer2D_Max_Triangle_Capacity * 6];
+		//6 per quad
+		struct Vertex
+		{
+			glm::vec2 position;
+			glm::vec4 color;
+			glm::vec2 texture;
+		};
+
+		//Vertices are written straight into streamMapped, a persistently mapped buffer split in
+		//GL2D_Renderer2D_Stream_Sections sections used round robin, one per frame in flight,
+		//each guarded by a fence. That needs GL 4.4 or ARB_buffer_storage.
+		//Without it (or without a context), and for the rest of a frame that outgrows its section,
+		//they are collected in spriteVertices and flush uploads them into an orphaned buffer.
+		//A section that overflowed is grown for the next frame.
+		GLuint streamBuffer = 0;
+		GLuint orphanBuffer = 0;
+		Vertex *streamMapped = nullptr;
+		size_t streamSectionSize = 0; //in vertices
+		int streamSection = 0;
+		size_t streamCount = 0; //vertices in the current section
+		bool streamDrawn = false; //the gpu may be reading the current section
+		GLsync streamFences[GL2D_Renderer2D_Stream_Sections] = {};
+
+		std::vector<Vertex> spriteVertices;
+		std::vector<Texture> spriteTextures; //one per quad
+
+		//room for count vertices of the quad being added
+		Vertex *allocateVertices(size_t count);
+
+		void createStreamBuffer(size_t sectionSize);
+		void deleteStreamBuffer();
+
+		//one per quad, the vertex shader expands it into the 4 corners
+		struct SolidQuad
+		{
+			glm::vec4 rect; //left, top, right, bottom in screen coordinates
+			unsigned char color[4]; //rgba8
+		};
 
-		//int spritePositionsCount = 0;
-		//int spriteColorsCount = 0;
-		//int texturePositionsCount = 0;
-		//int spriteTexturesCount = 0;
+		//renderSolidRectangle quads, drawn with a single instanced call at the start of a flush
+		GLuint solidVao = 0;
+		GLuint solidBuffer = 0;
+		std::vector<SolidQuad> solidQuads;
 
 		ShaderProgram currentShader = {};
 		std::vector<ShaderProgram> shaderPushPop;
@@ -394,18 +415,7 @@ namespace gl2d
 		glm::vec4 toScreen(const glm::vec4& transform);
 
 		//clears the things that are to be drawn when calling flush
-		inline void clearDrawData()
-		{
-			spritePositions.clear();
-			spriteColors.clear();
-			texturePositions.clear();
-			spriteTextures.clear();
-
-			//spritePositionsCount = 0;
-			//spriteColorsCount = 0;
-			//spriteTexturesCount = 0;
-			//texturePositionsCount = 0;
-		}
+		void clearDrawData();
 
 		glm::vec2 getTextSize(const char *text, const Font font, const float size = 1.5f,
 			const float spacing = 4, const float line_space = 3);
@@ -478,6 +488,12 @@ namespace gl2d
 			renderRectangleAbsRotation(transforms, c, origin, rotationDegrees);
 		}
 
+		//Axis aligned untextured rectangle, 20 bytes instead of 6 vertices.
+		//All of these are drawn before everything else in the same flush,
+		//so don't mix them with textured quads meant to go under them.
+		//Falls back to renderRectangle under a rotated camera or a custom shader.
+		void renderSolidRectangle(const Rect transforms, const Color4f color);
+
 		void renderLine(const glm::vec2 position, const float angleDegrees, const float length, const Color4f color, const float width = 2.f);
 
 		void renderLine(const glm::vec2 start, const glm::vec2 end, const Color4f color, const float width = 2.f);
@@ -1,5 +1,5 @@
 //////////////////////////////////////////////////
-//gl2d.cpp				1.5.0
+//gl2d.cpp				1.5.2
 //Copyright(c) 2020 Luta Vlad
 //https://github.com/meemknight/gl2d
 // 
@@ -54,6 +54,13 @@
 // started to add some more needed text functions
 // needed to be tested tho
 // 
+// 1.5.1
+// vertices stream into a persistently mapped buffer
+// interleaved vertex attributes
+// 
+// 1.5.2
+// instanced solid rectangles
+// 
 /////////////////////////////////////////////////////////
 
 
@@ -75,6 +82,7 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <cstddef>
 #include <iostream>
 
 //if you are not using visual studio make shure you link to "Opengl32.lib"
@@ -92,6 +100,7 @@ namespace gl2d
 #pragma region shaders
 
 	static ShaderProgram defaultShader = {};
+	static ShaderProgram solidShader = {};
 	static Camera defaultCamera{};
 	static Texture white1pxSquareTexture = {};
 
@@ -122,6 +131,30 @@ namespace gl2d
 		"    color = v_color * texture2D(u_sampler, v_texture);\n"
 		"}\n";
 
+	//one instance per quad, corners from gl_VertexID as a triangle strip
+	static const char* solidVertexShader =
+		GL2D_OPNEGL_SHADER_VERSION "\n"
+		GL2D_OPNEGL_SHADER_PRECISION "\n"
+		"in vec4 quad_positions;\n"
+		"in vec4 quad_colors;\n"
+		"out vec4 v_color;\n"
+		"void main()\n"
+		"{\n"
+		"	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+		"	gl_Position = vec4(mix(quad_positions.xy, quad_positions.zw, corner), 0, 1);\n"
+		"	v_color = quad_colors;\n"
+		"}\n";
+
+	static const char* solidFragmentShader =
+		GL2D_OPNEGL_SHADER_VERSION "\n"
+		GL2D_OPNEGL_SHADER_PRECISION "\n"
+		"out vec4 color;\n"
+		"in vec4 v_color;\n"
+		"void main()\n"
+		"{\n"
+		"    color = v_color;\n"
+		"}\n";
+
 #pragma endregion
 
 	static errorFuncType* errorFunc = defaultErrorFunc;
@@ -251,6 +284,7 @@ namespace gl2d
 	#endif
 
 		defaultShader = createShaderProgram(defaultVertexShader, defaultFragmentShader);
+		solidShader = createShaderProgram(solidVertexShader, solidFragmentShader);
 		white1pxSquareTexture.create1PxSquare();
 
 		enableNecessaryGLFeatures();
@@ -260,6 +294,7 @@ namespace gl2d
 	{
 		white1pxSquareTexture.cleanup();
 		glDeleteShader(defaultShader.id);
+		glDeleteShader(solidShader.id);
 		hasInitialized = false;
 	}
 
@@ -534,27 +569,72 @@ namespace gl2d
 			return;
 		}
 
-		if(renderer.spriteTextures.empty())
+		if(renderer.spriteTextures.empty() && renderer.solidQuads.empty())
 		{
 			return;
 		}
 
 		glViewport(0, 0, renderer.windowW, renderer.windowH);
 
+		if (!renderer.solidQuads.empty())
+		{
+			const GLsizeiptr bytes = renderer.solidQuads.size() * sizeof(Renderer2D::SolidQuad);
+
+			//the attribute pointers into solidBuffer are set once in create
+			glBindVertexArray(renderer.solidVao);
+			glBindBuffer(GL_ARRAY_BUFFER, renderer.solidBuffer);
+			glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, renderer.solidQuads.data());
+
+			glUseProgram(solidShader.id);
+
+			glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, renderer.solidQuads.size());
+		}
+
+		if (renderer.spriteTextures.empty())
+		{
+			glBindVertexArray(0);
+
+			if (clearDrawData)
+			{
+				renderer.clearDrawData();
+			}
+
+			return;
+		}
+
 		glBindVertexArray(renderer.vao);
 
 		glUseProgram(renderer.currentShader.id);
 
 		glUniform1i(renderer.currentShader.u_sampler, 0);
 
-		glBindBuffer(GL_ARRAY_BUFFER, renderer.buffers[Renderer2DBufferType::quadPositions]);
-		glBufferData(GL_ARRAY_BUFFER, renderer.spritePositions.size() * sizeof(glm::vec2), renderer.spritePositions.data(), GL_STREAM_DRAW);
+		GLint first = 0;
+
+		if (renderer.streamMapped && renderer.spriteVertices.empty())
+		{
+			//already in place, the fence for this section goes down in clearDrawData
+			glBindBuffer(GL_ARRAY_BUFFER, renderer.streamBuffer);
 
-		glBindBuffer(GL_ARRAY_BUFFER, renderer.buffers[Renderer2DBufferType::quadColors]);
-		glBufferData(GL_ARRAY_BUFFER, renderer.spriteColors.size() * sizeof(glm::vec4), renderer.spriteColors.data(), GL_STREAM_DRAW);
+			first = renderer.streamSection * renderer.streamSectionSize;
+
+			renderer.streamDrawn = true;
+		}
+		else
+		{
+			const GLsizeiptr bytes = renderer.spriteVertices.size() * sizeof(Renderer2D::Vertex);
+
+			//orphan the old storage so the driver doesn't wait for the last draw from it
+			glBindBuffer(GL_ARRAY_BUFFER, renderer.orphanBuffer);
+			glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, renderer.spriteVertices.data());
+		}
 
-		glBindBuffer(GL_ARRAY_BUFFER, renderer.buffers[Renderer2DBufferType::texturePositions]);
-		glBufferData(GL_ARRAY_BUFFER, renderer.texturePositions.size() * sizeof(glm::vec2), renderer.texturePositions.data(), GL_STREAM_DRAW);
+		const GLsizei stride = sizeof(Renderer2D::Vertex);
+
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Renderer2D::Vertex, position));
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Renderer2D::Vertex, color));
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Renderer2D::Vertex, texture));
 
 		//Instance render the textures
 		{
@@ -568,7 +648,7 @@ namespace gl2d
 			{
 				if (renderer.spriteTextures[i].id != id)
 				{
-					glDrawArrays(GL_TRIANGLES, pos * 6, 6 * (i - pos));
+					glDrawArrays(GL_TRIANGLES, first + pos * 6, 6 * (i - pos));
 
 					pos = i;
 					id = renderer.spriteTextures[i].id;
@@ -578,7 +658,7 @@ namespace gl2d
 
 			}
 
-			glDrawArrays(GL_TRIANGLES, pos * 6, 6 * (size - pos));
+			glDrawArrays(GL_TRIANGLES, first + pos * 6, 6 * (size - pos));
 
 			glBindVertexArray(0);
 		}
@@ -703,27 +783,14 @@ namespace gl2d
 		v3.y = internal::positionToScreenCoordsY(v3.y, (float)windowH);
 		v4.y = internal::positionToScreenCoordsY(v4.y, (float)windowH);
 
-		spritePositions.push_back(glm::vec2{ v1.x, v1.y });
-		spritePositions.push_back(glm::vec2{ v2.x, v2.y });
-		spritePositions.push_back(glm::vec2{ v4.x, v4.y });
-
-		spritePositions.push_back(glm::vec2{ v2.x, v2.y });
-		spritePositions.push_back(glm::vec2{ v3.x, v3.y });
-		spritePositions.push_back(glm::vec2{ v4.x, v4.y });
+		Vertex *vertices = allocateVertices(6);
 
-		spriteColors.push_back(colors[0]);
-		spriteColors.push_back(colors[1]);
-		spriteColors.push_back(colors[3]);
-		spriteColors.push_back(colors[1]);
-		spriteColors.push_back(colors[2]);
-		spriteColors.push_back(colors[3]);
-
-		texturePositions.push_back(glm::vec2{ textureCoords.x, textureCoords.y }); //1
-		texturePositions.push_back(glm::vec2{ textureCoords.x, textureCoords.w }); //2
-		texturePositions.push_back(glm::vec2{ textureCoords.z, textureCoords.y }); //4
-		texturePositions.push_back(glm::vec2{ textureCoords.x, textureCoords.w }); //2
-		texturePositions.push_back(glm::vec2{ textureCoords.z, textureCoords.w }); //3
-		texturePositions.push_back(glm::vec2{ textureCoords.z, textureCoords.y }); //4
+		vertices[0] = { v1, colors[0], glm::vec2{ textureCoords.x, textureCoords.y } }; //1
+		vertices[1] = { v2, colors[1], glm::vec2{ textureCoords.x, textureCoords.w } }; //2
+		vertices[2] = { v4, colors[3], glm::vec2{ textureCoords.z, textureCoords.y } }; //4
+		vertices[3] = { v2, colors[1], glm::vec2{ textureCoords.x, textureCoords.w } }; //2
+		vertices[4] = { v3, colors[2], glm::vec2{ textureCoords.z, textureCoords.w } }; //3
+		vertices[5] = { v4, colors[3], glm::vec2{ textureCoords.z, textureCoords.y } }; //4
 
 		spriteTextures.push_back(textureCopy);
 	}
@@ -738,6 +805,45 @@ namespace gl2d
 		renderRectangleAbsRotation(transforms, white1pxSquareTexture, colors, origin, rotation);
 	}
 
+	void Renderer2D::renderSolidRectangle(const Rect transforms, const Color4f color)
+	{
+		if (currentCamera.rotation != 0 || currentShader.id != defaultShader.id)
+		{
+			renderRectangle(transforms, color);
+			return;
+		}
+
+		//the same steps as renderRectangleAbsRotation, on the top left and bottom right corners only
+		glm::vec2 v1 = { transforms.x,				  -transforms.y };
+		glm::vec2 v3 = { transforms.x + transforms.z, -transforms.y - transforms.w };
+
+		const glm::vec2 camera = { -currentCamera.position.x, currentCamera.position.y };
+
+		v1 += camera;
+		v3 += camera;
+
+		const glm::vec2 cameraCenter = { windowW / 2.0f, -windowH / 2.0f };
+
+		v1 = scaleAroundPoint(v1, cameraCenter, currentCamera.zoom);
+		v3 = scaleAroundPoint(v3, cameraCenter, currentCamera.zoom);
+
+		SolidQuad quad;
+
+		quad.rect.x = internal::positionToScreenCoordsX(v1.x, (float)windowW);
+		quad.rect.y = internal::positionToScreenCoordsY(v1.y, (float)windowH);
+		quad.rect.z = internal::positionToScreenCoordsX(v3.x, (float)windowW);
+		quad.rect.w = internal::positionToScreenCoordsY(v3.y, (float)windowH);
+
+		const glm::vec4 clamped = glm::clamp(color, 0.f, 1.f) * 255.f + 0.5f;
+
+		quad.color[0] = (unsigned char)clamped.r;
+		quad.color[1] = (unsigned char)clamped.g;
+		quad.color[2] = (unsigned char)clamped.b;
+		quad.color[3] = (unsigned char)clamped.a;
+
+		solidQuads.push_back(quad);
+	}
+
 	void Renderer2D::renderLine(const glm::vec2 position, const float angleDegrees, const float length, const Color4f color, const float width)
 	{
 		renderRectangle({position - glm::vec2(0,width / 2.f), length, width},
@@ -1142,9 +1248,6 @@ namespace gl2d
 		defaultFBO = fbo;
 
 		clearDrawData();
-		spritePositions.reserve(quadCount * 6);
-		spriteColors.reserve(quadCount * 6);
-		texturePositions.reserve(quadCount * 6);
 		spriteTextures.reserve(quadCount);
 
 		this->resetCameraAndShader();
@@ -1152,27 +1255,174 @@ namespace gl2d
 		glGenVertexArrays(1, &vao);
 		glBindVertexArray(vao);
 
-		glGenBuffers(Renderer2DBufferType::bufferSize, buffers);
+		//the attribute pointers are set by every flush, for whichever buffer it draws from
+		glGenBuffers(1, &orphanBuffer);
 
-		glBindBuffer(GL_ARRAY_BUFFER, buffers[Renderer2DBufferType::quadPositions]);
 		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
-
-		glBindBuffer(GL_ARRAY_BUFFER, buffers[Renderer2DBufferType::quadColors]);
 		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
-
-		glBindBuffer(GL_ARRAY_BUFFER, buffers[Renderer2DBufferType::texturePositions]);
 		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+		glGenVertexArrays(1, &solidVao);
+		glBindVertexArray(solidVao);
+
+		glGenBuffers(1, &solidBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, solidBuffer);
+
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(SolidQuad), (void*)offsetof(SolidQuad, rect));
+		glVertexAttribDivisor(0, 1);
+
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SolidQuad), (void*)offsetof(SolidQuad, color));
+		glVertexAttribDivisor(1, 1);
 
 		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		solidQuads.reserve(quadCount);
+
+		createStreamBuffer(quadCount * 6);
+
+		if (!streamMapped)
+		{
+			spriteVertices.reserve(quadCount * 6);
+		}
 	}
 
 	void Renderer2D::cleanup()
 	{
+		deleteStreamBuffer();
+
 		glDeleteVertexArrays(1, &vao);
-		glDeleteBuffers(Renderer2DBufferType::bufferSize, buffers);
+		glDeleteBuffers(1, &orphanBuffer);
+
+		glDeleteVertexArrays(1, &solidVao);
+		glDeleteBuffers(1, &solidBuffer);
+	}
+
+	void Renderer2D::createStreamBuffer(size_t sectionSize)
+	{
+		deleteStreamBuffer();
+
+		if (!glBufferStorage)
+		{
+			return;
+		}
+
+		const GLsizeiptr bytes = sectionSize * GL2D_Renderer2D_Stream_Sections * sizeof(Vertex);
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		glGenBuffers(1, &streamBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, streamBuffer);
+		glBufferStorage(GL_ARRAY_BUFFER, bytes, nullptr, flags);
+
+		streamMapped = (Vertex*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags);
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		if (!streamMapped)
+		{
+			deleteStreamBuffer();
+			return;
+		}
+
+		streamSectionSize = sectionSize;
+		streamSection = 0;
+		streamCount = 0;
+		streamDrawn = false;
+	}
+
+	void Renderer2D::deleteStreamBuffer()
+	{
+		for (GLsync &fence : streamFences)
+		{
+			if (fence)
+			{
+				glDeleteSync(fence);
+				fence = 0;
+			}
+		}
+
+		if (streamBuffer)
+		{
+			//the driver keeps the storage alive until draws still reading it are done
+			glBindBuffer(GL_ARRAY_BUFFER, streamBuffer);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+			glDeleteBuffers(1, &streamBuffer);
+		}
+
+		streamBuffer = 0;
+		streamMapped = nullptr;
+		streamSectionSize = 0;
+		streamCount = 0;
+		streamDrawn = false;
+	}
+
+	Renderer2D::Vertex *Renderer2D::allocateVertices(size_t count)
+	{
+		if (streamMapped && spriteVertices.empty())
+		{
+			if (streamCount == 0 && streamFences[streamSection])
+			{
+				//only blocks when the gpu is a whole ring of frames behind
+				GLsync &fence = streamFences[streamSection];
+
+				while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000) == GL_TIMEOUT_EXPIRED) {}
+
+				glDeleteSync(fence);
+				fence = 0;
+			}
+
+			Vertex *section = streamMapped + streamSection * streamSectionSize;
+
+			if (streamCount + count <= streamSectionSize)
+			{
+				Vertex *vertices = section + streamCount;
+				streamCount += count;
+				return vertices;
+			}
+
+			//this frame outgrew the section, finish it in memory and grow the section at clearDrawData
+			spriteVertices.reserve(streamSectionSize * 2);
+			spriteVertices.assign(section, section + streamCount);
+		}
+
+		const size_t size = spriteVertices.size();
+
+		spriteVertices.resize(size + count);
+
+		return spriteVertices.data() + size;
+	}
+
+	void Renderer2D::clearDrawData()
+	{
+		if (streamMapped)
+		{
+			if (streamDrawn)
+			{
+				if (streamFences[streamSection])
+				{
+					glDeleteSync(streamFences[streamSection]);
+				}
+
+				streamFences[streamSection] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+				streamSection = (streamSection + 1) % GL2D_Renderer2D_Stream_Sections;
+			}
+
+			if (spriteVertices.size() > streamSectionSize)
+			{
+				createStreamBuffer(std::max(spriteVertices.size(), streamSectionSize * 2));
+			}
+		}
+
+		streamCount = 0;
+		streamDrawn = false;
+
+		spriteVertices.clear();
+		spriteTextures.clear();
+		solidQuads.clear();
 	}
 
 	void Renderer2D::pushShader(ShaderProgram s)